@@ -0,0 +1,93 @@
+#!/bin/bash
+#
+# Run the benchmark searches listed in bench.ref and compare them with
+# the reference values there.  Each search is run to the end with -a, and
+# its nodes (cells chosen or reversed), conflicts, objects found and the
+# checksum of the objects are taken from the -stats record and the output
+# file.  Any change in those is a change in the behavior of the search,
+# not a change in speed, and makes the benchmark fail.  The speed is only
+# reported, as nodes per second compared with the reference.
+#
+# usage: bench.sh [-u]
+#   -u  write the values of this run into bench.ref as the new reference
+#
+# The program to run can be given in LIFESRC, and defaults to ./lifesrcdumb.
+
+LIFESRC="${LIFESRC:-./lifesrcdumb}"
+REF="$(dirname "$0")/bench.ref"
+
+update=0
+
+if [[ "$1" == "-u" ]]; then
+  update=1
+fi
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+changed=0
+
+printf "%-8s %8s %10s %10s %8s %12s %7s  %s\n" \
+  case wall nodes conflicts found nodes/sec speed result
+
+while IFS= read -r line; do
+  if [[ -z "$line" || "$line" == \#* ]]; then
+    echo "$line" >> "$tmp/ref"
+    continue
+  fi
+
+  read -r name nodes confl found sum rate args <<< "$line"
+
+  rm -f "$tmp/out" "$tmp/stats"
+
+  start=$EPOCHREALTIME
+  $LIFESRC $args -a -b -q -o "$tmp/out" -stats "$tmp/stats" > /dev/null 2>&1
+  end=$EPOCHREALTIME
+
+  record=$(tail -1 "$tmp/stats" 2> /dev/null)
+  newNodes=$(sed -n 's/.*"nodes":\([0-9]*\).*/\1/p' <<< "$record")
+  newConfl=$(sed -n 's/.*"conflicts":\([0-9]*\).*/\1/p' <<< "$record")
+  newFound=$(sed -n 's/.*"found":\([0-9]*\).*/\1/p' <<< "$record")
+  elapsed=$(sed -n 's/.*"elapsed":\([0-9.]*\).*/\1/p' <<< "$record")
+  newSum=$(cat "$tmp/out" 2> /dev/null | cksum | cut -d ' ' -f 1)
+
+  if [[ -z "$newNodes" ]]; then
+    newNodes=0 newConfl=0 newFound=0 elapsed=0
+  fi
+
+  read -r wall newRate speed <<< $(awk -v s="$start" -v e="$end" \
+    -v n="$newNodes" -v t="$elapsed" -v r="$rate" 'BEGIN {
+      rate = (t > 0) ? n / t : 0
+      printf "%.3f %.0f %.2f\n", e - s, rate, (r > 0) ? rate / r : 0 }')
+
+  if [[ "$newNodes $newConfl $newFound $newSum" == \
+        "$nodes $confl $found $sum" ]]; then
+    result=same
+  else
+    result=CHANGED
+    changed=1
+  fi
+
+  printf "%-8s %8s %10s %10s %8s %12s %6sx  %s\n" \
+    "$name" "$wall" "$newNodes" "$newConfl" "$newFound" "$newRate" \
+    "$speed" "$result"
+
+  if [[ "$result" == CHANGED ]]; then
+    echo "         expected nodes $nodes conflicts $confl found $found" \
+      "checksum $sum, got checksum $newSum"
+  fi
+
+  echo "$name $newNodes $newConfl $newFound $newSum $newRate $args" \
+    >> "$tmp/ref"
+done < "$REF"
+
+if [[ $update == 1 ]]; then
+  cp "$tmp/ref" "$REF"
+  echo "Reference values written to $REF"
+  exit 0
+fi
+
+if [[ $changed == 1 ]]; then
+  echo "The search behaves differently from the reference"
+  exit 1
+fi
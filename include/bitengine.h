@@ -0,0 +1,11 @@
+#ifndef BITENGINE_H
+#define BITENGINE_H
+
+#include "state.h"
+
+void bitInit(void);
+void bitFree(void);
+void bitUpdate(const Cell * const cell, const State state);
+Status bitPropagate(void);
+
+#endif /* BITENGINE_H */
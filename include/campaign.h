@@ -0,0 +1,6 @@
+#ifndef CAMPAIGN_H
+#define CAMPAIGN_H
+
+int runCampaign(int argc, char ** argv);
+
+#endif /* CAMPAIGN_H */
@@ -0,0 +1,11 @@
+#ifndef DYNORDER_H
+#define DYNORDER_H
+
+#include "state.h"
+
+void dynInit(Cell ** const list, const int count);
+void dynFree(void);
+void dynUpdate(Cell * const cell, const State oldState);
+Cell * dynFirst(void);
+
+#endif /* DYNORDER_H */
@@ -0,0 +1,12 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "state.h"
+
+void heatInit(void);
+void heatFree(void);
+void heatSettings(Cell ** mark, const Bool free);
+void heatConflict(const Cell * const cell);
+void writeHeat(const char * prefix);
+
+#endif /* HEATMAP_H */
@@ -0,0 +1,11 @@
+#ifndef LEADER_H
+#define LEADER_H
+
+#include "state.h"
+
+void leaderInit(Cell ** const list, const int count);
+void leaderStart(void);
+void leaderFree(void);
+Bool leaderOk(void);
+
+#endif /* LEADER_H */
@@ -0,0 +1,22 @@
+#ifndef LEARN_H
+#define LEARN_H
+
+#include "state.h"
+
+/*
+ * Reasons why a cell was set, kept in the low bits of the reason table.
+ */
+#define	REASON_CHOICE	0	/* chosen, or set from outside the search */
+#define	REASON_SITE	1	/* forced by a cell and the cells around its past */
+#define	REASON_CLAUSE	3	/* forced by a learned clause */
+#define	REASON_LIMIT	4	/* broke a limit of generation 0 */
+#define	REASON_BITS	3	/* bits used for the kind of reason */
+
+void learnInit(void);
+void learnFree(void);
+void learnSet(const Cell * const cell);
+Status learnError(const int kind, const Cell * const cell);
+Status learnPropagate(const Cell * const cell);
+Cell ** learnConflict(Cell ** const cellPtr, State * const statePtr);
+
+#endif /* LEARN_H */
@@ -0,0 +1,27 @@
+#ifndef LIFEAPI_H
+#define LIFEAPI_H
+
+#include "state.h"
+
+/*
+ * A search which runs on a thread of its own, so that several searches
+ * can be run at once within one process.
+ */
+typedef struct LifeSearch LifeSearch;
+
+/*
+ * Routine called on the thread of a search for each object found.
+ */
+typedef void (*LifeFound)(LifeSearch * life, void * arg);
+
+LifeSearch * lifeCreate(LifeFound found, void * arg);
+Status lifeConfigure(LifeSearch * life, int argc, char ** argv);
+Status lifeStep(LifeSearch * life);
+void lifeDump(LifeSearch * life);
+void lifeCancel(LifeSearch * life);
+long lifeConflicts(const LifeSearch * life);
+State lifeCell(const LifeSearch * life, int row, int col, int gen);
+const char * lifeError(const LifeSearch * life);
+void lifeDestroy(LifeSearch * life);
+
+#endif /* LIFEAPI_H */
@@ -0,0 +1,7 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+long parallelSearch(const int count);
+void donateWork(void);
+
+#endif /* PARALLEL_H */
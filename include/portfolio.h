@@ -0,0 +1,6 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+int runPortfolio(int argc, char ** argv);
+
+#endif /* PORTFOLIO_H */
@@ -4,5 +4,6 @@
 #include "state.h"
 
 void setState(Cell * const cell, const State state);
+void setVar(Cell * const cell, const State state);
 
 #endif /* SETSTATE_H */
@@ -0,0 +1,8 @@
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+#include "state.h"
+
+const char * classifyObject(const int gen);
+
+#endif /* SIMULATE_H */
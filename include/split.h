@@ -0,0 +1,6 @@
+#ifndef SPLIT_H
+#define SPLIT_H
+
+int splitSearch(const int count, const char * const file);
+
+#endif /* SPLIT_H */
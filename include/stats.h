@@ -0,0 +1,9 @@
+#ifndef STATS_H
+#define STATS_H
+
+void statsStart(void);
+void writeStats(void);
+double searchDone(void);
+double searchEta(void);
+
+#endif /* STATS_H */
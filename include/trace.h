@@ -0,0 +1,31 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "state.h"
+
+/*
+ * Kinds of events kept in the trace.
+ */
+#define	TRACE_SET	0	/* cell was set */
+#define	TRACE_FORCE	1	/* unknown neighbors of a cell were forced */
+#define	TRACE_CONFLICT	2	/* cell could not be set */
+#define	TRACE_BACKUP	3	/* cell was backed up */
+#define	TRACE_DECIDE	4	/* cell was chosen */
+#define	TRACE_EXAMINE	5	/* cell was examined for consistency */
+
+/*
+ * Add an event to the trace if tracing is turned on, which otherwise
+ * costs only the test of the flag.
+ */
+#define	TRACE(kind, cell, state, free) \
+	if (tracing) traceEvent((kind), (cell), (state), (free))
+
+void traceStart(void);
+void traceStop(void);
+void traceEnd(void);
+void traceEvent(const int kind, const Cell * const cell, const State state,
+	const Bool free);
+void writeTrace(const char * file);
+int decodeTrace(const char * file);
+
+#endif /* TRACE_H */
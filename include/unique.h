@@ -0,0 +1,10 @@
+#ifndef UNIQUE_H
+#define UNIQUE_H
+
+#include "state.h"
+
+Bool uniqueObject(void);
+void uniqueShare(void);
+void uniqueUnshare(void);
+
+#endif /* UNIQUE_H */
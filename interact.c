@@ -4,8 +4,11 @@
  */
 
 #include <ctype.h>
+#include <errno.h>
 #include <time.h>
+#include <unistd.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 
 #include "lifesrc.h"
 #include "state.h"
@@ -16,25 +19,35 @@
 #include "sortorder.h"
 #include "sectohms.h"
 #include "outputtimers.h"
+#include "parallel.h"
+#include "campaign.h"
+#include "split.h"
+#include "portfolio.h"
+#include "leader.h"
+#include "simulate.h"
+#include "stats.h"
+#include "heatmap.h"
+#include "trace.h"
 
 #define	VERSION	"3.8"
 
 
 /*
- * Local data.
+ * Local data, which belongs to the search of the current thread.
  */
-static	Bool	noWait;		/* don't wait for commands after loading */
-static	Bool	setAll;		/* set all cells from initial file */
-static	Bool	isLife;		/* whether the rules are for standard Life */
-static	char	ruleString[20];	/* rule string for printouts */
-static	long	foundCount;	/* number of objects found */
-static	char *	initFile;	/* file containing initial cells */
-static	char *	loadFile;	/* file to load state from */
-static  Bool    blockOutput; /* print Unicode blocks instead of character */
-static  Bool    RLEOutput;  /* print additional RLE code */
-static  Bool    augmentOutput;  /* print additional UTF8 code for stateList info */
-static time_t startTime;
-static char timeBuf[256] = {0};
+static	SEARCH_LOCAL	Bool	noWait;		/* don't wait for commands after loading */
+static	SEARCH_LOCAL	Bool	setAll;		/* set all cells from initial file */
+static	SEARCH_LOCAL	Bool	isLife;		/* whether the rules are for standard Life */
+static	SEARCH_LOCAL	char	ruleString[20];	/* rule string for printouts */
+static	SEARCH_LOCAL	char *	initFile;	/* file containing initial cells */
+static	SEARCH_LOCAL	char *	loadFile;	/* file to load state from */
+static SEARCH_LOCAL  Bool    blockOutput; /* print Unicode blocks instead of character */
+static SEARCH_LOCAL  Bool    RLEOutput;  /* print additional RLE code */
+static SEARCH_LOCAL  Bool    augmentOutput;  /* print additional UTF8 code for stateList info */
+static	SEARCH_LOCAL	pid_t	dumpPid;	/* process writing a dump, or zero */
+static	SEARCH_LOCAL	const char *	dumpPath;	/* file it is writing */
+static SEARCH_LOCAL time_t startTime;
+static SEARCH_LOCAL char timeBuf[256] = {0};
 
 /*
  * Local procedures
@@ -48,6 +61,14 @@ static	void		getFreeze(const char *);
 static	void		excludeCone(int, int, int);
 static	void		freezeCell(int, int);
 static	Status		loadState(const char *);
+static	Bool		reapDump(Bool);
+static	Status		loadBinary(FILE *, const char *);
+static	unsigned long	cellNumber(const Cell * const);
+static	Cell *		numberCell(unsigned long);
+static	unsigned long	cellWord(const Cell * const);
+static	unsigned long	dumpSum(void);
+static	void		putWord(FILE *, unsigned long);
+static	unsigned long	getWord(FILE *);
 static	Status		readFile(const char *);
 static	Bool		confirm(const char *);
 static	Bool		setRules(const char *);
@@ -57,7 +78,8 @@ static	const char *	getStr(const char *, const char *);
 void alarm_handler(const int signo)
 {
     if (signo == SIGUSR1) dumpFlag = TRUE;
-    if (signo == SIGUSR2) viewFlag = TRUE;
+    if (signo == SIGUSR2) viewFlag = statsFlag = TRUE;
+    if (signo == SIGHUP) heatFlag = traceFlag = TRUE;
 }
 
 
@@ -66,32 +88,34 @@ void alarm_handler(const int signo)
  * Changing this table may invalidate old dump files, unless new
  * parameters are added at the end and default to zero.
  * When changed incompatibly, the dump file version should be incremented.
- * The table is ended with a NULL pointer.
+ * The table is ended with a NULL pointer.  Since the parameters belong to
+ * the search of the current thread, their addresses are not constant, so
+ * this is the initializer of a local table in each routine using it.
  */
-static	int *	paramTable[] =
-{
-	&curStatus,
-	&rowMax, &colMax, &genMax, &rowTrans, &colTrans,
-	&rowSym, &colSym, &pointSym, &fwdSym, &bwdSym,
-	&flipRows, &flipCols, &flipFwd, &flipBwd, &flipQuads,
-	&parent, &allObjects, &nearCols, &maxCount,
-	&useRow, &useCol, &colCells, &colWidth, &follow,
-	&orderWide, &orderGens, &orderInvert, &orderMiddle, &followGens,
-	&chooseUnknown,	&sortOrder, NULL
-};
+#define	PARAM_TABLE \
+{ \
+	&curStatus, \
+	&rowMax, &colMax, &genMax, &rowTrans, &colTrans, \
+	&rowSym, &colSym, &pointSym, &fwdSym, &bwdSym, \
+	&flipRows, &flipCols, &flipFwd, &flipBwd, &flipQuads, \
+	&parent, &allObjects, &nearCols, &maxCount, \
+	&useRow, &useCol, &colCells, &colWidth, &follow, \
+	&orderWide, &orderGens, &orderInvert, &orderMiddle, &followGens, \
+	&chooseUnknown,	&sortOrder, &orderDynamic, &symMask, NULL \
+}
 
 
 int
 main(int argc, char ** argv)
 {
-    struct sigaction actDump, actView;
+    struct sigaction actDump, actView, actHeat;
     struct sigevent sevDump, sevView;
     struct itimerspec itsDump, itsView;
     timer_t tidDump, tidView;
 
     time_t end;
     long dif = 0;
-	const char *	str;
+	const char *	msg;
 
     setSigaction(&actDump, SIGUSR1, &alarm_handler);
     setSigaction(&actView, SIGUSR2, &alarm_handler);
@@ -104,8 +128,265 @@ main(int argc, char ** argv)
 
 	argv++;
 
+	/*
+	 * A campaign runs many searches by itself.
+	 */
+	if (strcmp(*argv, "--campaign") == 0)
+		exit(runCampaign(argc - 1, argv + 1));
+
+	/*
+	 * Decoding a trace file needs no search at all.
+	 */
+	if ((strcmp(*argv, "--decode") == 0) && (argc == 2))
+		exit(decodeTrace(argv[1]));
+
+	msg = setOptions(argc, argv);
+
+	if (msg && (*msg == '\0'))
+	{
+		usage();
+		exit(1);
+	}
+
+	if (msg)
+		fatal(msg);
+
+	if (portfolio)
+		exit(runPortfolio(argc, argv));
+
+	/*
+	 * Write the heatmap when asked to by a hangup signal.  Tracing
+	 * sets up the signal for the trace by itself.
+	 */
+	if (heatFile)
+		setSigaction(&actHeat, SIGHUP, &alarm_handler);
+
+	if (traceFile)
+		traceStart();
+
+	/*
+	 * Make the timers for dumping and viewing.
+	 */
+	if (dumpFreq)
+		createTimer(&sevDump, &itsDump, &tidDump, SIGUSR1, dumpFreq);
+
+	createTimer(&sevView, &itsView, &tidView, SIGUSR2, viewFreq);
+
+    if (!noWait)
+    {
+	    if (!ttyOpen())
+		    fatal("Cannot initialize terminal");
+    }
+
+	if (setupSearch() != OK)
+	{
+		ttyClose();
+		exit(1);
+	}
+
+	if (splitCount)
+	{
+		ttyClose();
+		exit(splitSearch(splitCount, splitFile));
+	}
+
+	/*
+	 * If we are looking for parents, then set the current generation
+	 * to the last one so that it can be input easily.  Then get the
+	 * commands to initialize the cells, unless we were told to not wait.
+	 */
+	if (parent)
+		curGen = genMax - 1;
+
+	if (noWait)
+	{
+	    if (!quiet)
+		    printGen(0);
+    }
+	else
+		getCommands();
+
+	leaderStart();
+	statsStart();
+	inited = TRUE;
+
+    /*
+     * Arm the output timers
+     */
+    if (dumpFreq)
+    {
+        if (timer_settime(tidDump, 0, &itsDump, NULL) == -1)
+        {
+            perror("timer_settime Dump failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (timer_settime(tidView, 0, &itsView, NULL) == -1)
+    {
+        perror("timer_settime View failed");
+        exit(EXIT_FAILURE);
+    }
+
+	/*
+	 * If more than one worker was asked for, then search in parallel.
+	 * This completes the whole search.
+	 */
+	if (workers > 1)
+	{
+		/*
+		 * Objects are written from generation 0, as in the serial
+		 * search, even when the last one was shown for input.
+		 */
+		curGen = 0;
+		time(&startTime);
+		foundCount = parallelSearch(workers);
+		time(&end);
+		secToHMS(end - startTime, timeBuf);
+
+		if (foundCount == 0)
+		{
+			printf("Total time searched%s.\n", timeBuf);
+			fatal("No objects found.");
+		}
+
+		ttyClose();
+
+		if (!quiet)
+		{
+			printf("Search completed in%s", timeBuf);
+
+			if (outputFile)
+				printf(", file \"%s\" contains", outputFile);
+			else
+				printf(", found");
+
+			printf(" %ld object%s\n",
+				foundCount, (foundCount == 1) ? "" : "s");
+		}
+
+		exit(0);
+	}
+
+	/*
+	 * Initial commands are complete, now look for the object.
+	 */
+	while (TRUE)
+	{
+		if (curStatus == OK)
+		{
+			time(&startTime);
+			curStatus = search(noWait);
+			time(&end);
+			dif = end - startTime;
+			secToHMS(dif, timeBuf);
+
+			/*
+			 * Record the final statistics and heatmap when the
+			 * search runs out of objects.
+			 */
+			if (statsFile && (curStatus != FOUND))
+				writeStats();
+
+			if (heatFile && (curStatus != FOUND))
+				writeHeat(heatFile);
+
+			/*
+			 * Skip objects which are not wanted, checking each
+			 * one only once as it is found.
+			 */
+			if ((curStatus == FOUND) && !acceptObject())
+			{
+				curStatus = OK;
+				continue;
+			}
+        }
+
+		if (dumpFreq)
+        {
+            dumpState(dumpFile);
+        }
+
+		quitOk = (curStatus == NOT_EXIST);
+
+		curGen = 0;
+
+		if (outputFile == NULL)
+		{
+			if (!noWait)
+			{
+				getCommands();
+				continue;
+			}
+		}
+
+		/*
+		 * Here if results are going to a file.
+		 */
+		if (curStatus == FOUND)
+		{
+			curStatus = OK;
+
+			foundCount++;
+
+			if (!quiet)
+			{
+				printGen(0);
+				ttyStatus("Object %ld found in%s.\n", foundCount, timeBuf);
+			}
+
+			writeGen(outputFile, TRUE);
+			if (noWait)
+			{
+			    if (allObjects)
+			        continue;
+			}
+			else
+			    continue;
+		}
+
+		/*
+		 * A search which stops at its first object also ends here,
+		 * so record its final statistics and heatmap too.
+		 */
+		if (statsFile && (curStatus != NOT_EXIST))
+			writeStats();
+
+		if (heatFile && (curStatus != NOT_EXIST))
+			writeHeat(heatFile);
+
+		if (foundCount == 0)
+		{
+		    printf("Total time searched%s.\n", timeBuf);
+			fatal("No objects found.");
+        }
+		ttyClose();
+
+		if (!quiet)
+		{
+			printf("Search completed, file \"%s\" contains %ld object%s\n",
+				outputFile, foundCount, (foundCount == 1) ? "" : "s");
+        }
+		exit(0);
+	}
+}
+
+
+/*
+ * Set the options of a search from arguments like those of the command
+ * line, after setting the defaults.  The options are checked for being
+ * consistent with each other.
+ * Returns NULL on success, or else a message about the problem, which
+ * is empty if the usage text should be shown instead.
+ */
+const char *
+setOptions(int argc, char ** argv)
+{
+	const char *	str;
+	static SEARCH_LOCAL char	optionBuf[32];
+
 	if (!setRules("3/23"))
-		fatal("Cannot set Life rules!");
+		return "Cannot set Life rules!";
 
 	/*
 	 * Set a couple of defaults.
@@ -113,6 +394,7 @@ main(int argc, char ** argv)
 	viewFreq = 10;
 	dumpFreq = 0;
 	colMax = 75;
+	symMask = SYM_FIND;
 
 	/*
 	 * Collect the command line options.
@@ -122,10 +404,7 @@ main(int argc, char ** argv)
 		str = *argv++;
 
 		if (*str++ != '-')
-		{
-			usage();
-			exit(1);
-		}
+			return "";
 
 		switch (*str++)
 		{
@@ -179,7 +458,7 @@ main(int argc, char ** argv)
 						break;
 
 					default:
-						fatal("Bad translate");
+						return "Bad translate";
 				}
 
 				break;
@@ -231,7 +510,7 @@ main(int argc, char ** argv)
 						break;
 
 					default:
-						fatal("Bad flip");
+						return "Bad flip";
 				}
 
 				break;
@@ -258,7 +537,48 @@ main(int argc, char ** argv)
 
 						break;
 
+					case 't':
+						/*
+						 * The -stats option is not a symmetry,
+						 * but appends statistics to a file.
+						 */
+						if (strcmp(str, "ats"))
+							return "Bad symmetry";
+
+						if ((argc <= 0) || (**argv == '-'))
+							return "Missing statistics file name";
+
+						statsFile = *argv++;
+						argc--;
+						break;
+
 					case 'p':
+						/*
+						 * The -split option is not a symmetry,
+						 * but splits the search into parts.
+						 */
+						if (strncmp(str, "lit", 3) == 0)
+						{
+							str += 3;
+
+							if ((*str == '\0') && (argc > 0))
+							{
+								argc--;
+								str = *argv++;
+							}
+
+							splitCount = atoi(str);
+							splitFile = SPLIT_FILE;
+
+							if ((argc > 0) && (**argv != '-'))
+							{
+								argc--;
+								splitFile = *argv++;
+							}
+
+							break;
+						}
+
 						pointSym = TRUE;
 						break;
 
@@ -270,8 +590,12 @@ main(int argc, char ** argv)
 						bwdSym = TRUE;
 						break;
 
+					case 'n':
+						symMask = 0;
+						break;
+
 					default:
-						fatal("Bad symmetry");
+						return "Bad symmetry";
 				}
 
 				break;
@@ -287,7 +611,7 @@ main(int argc, char ** argv)
 						break;
 
 					default:
-						fatal("Bad near");
+						return "Bad near";
 				}
 
 				break;
@@ -303,7 +627,7 @@ main(int argc, char ** argv)
 						break;
 
 					default:
-						fatal("Bad width");
+						return "Bad width";
 				}
 
 				break;
@@ -323,17 +647,23 @@ main(int argc, char ** argv)
 						break;
 
 					default:
-						fatal("Bad use");
+						return "Bad use";
 				}
 
 				break;
 
 			case 'd':
 				/*
-				 * Get dump frequency.
+				 * Get dump frequency, and whether to dump
+				 * from a forked copy of the process.
 				 */
+				if (*str == 'f')
+				{
+					forkDumps = TRUE;
+					str++;
+				}
+
 				dumpFreq = atoi(str);
-                createTimer(&sevDump, &itsDump, &tidDump, SIGUSR1, dumpFreq);
 
 				dumpFile = DUMP_FILE;
 
@@ -365,7 +695,6 @@ main(int argc, char ** argv)
 			    }
 				if (*str)
 					viewFreq = atoi(str);
-                createTimer(&sevView, &itsView, &tidView, SIGUSR2, viewFreq);
 
 				break;
 
@@ -377,7 +706,7 @@ main(int argc, char ** argv)
 					noWait = TRUE;
 
 				if ((argc <= 0) || (**argv == '-'))
-					fatal("Missing load file name");
+					return "Missing load file name";
 
 				loadFile = *argv++;
 				argc--;
@@ -396,7 +725,7 @@ main(int argc, char ** argv)
 					setAll = TRUE;
 
 				if ((argc <= 0) || (**argv == '-'))
-					fatal("Missing initial file name");
+					return "Missing initial file name";
 
 				initFile = *argv++;
 				argc--;
@@ -414,7 +743,7 @@ main(int argc, char ** argv)
 					outputCols = atol(str);
 
 					if ((argc <= 0) || (**argv == '-'))
-						fatal("Missing output file name");
+						return "Missing output file name";
 
 					outputFile = *argv++;
 					argc--;
@@ -444,6 +773,10 @@ main(int argc, char ** argv)
 							orderMiddle = TRUE;
 							break;
 
+						case 'd':
+							orderDynamic = TRUE;
+							break;
+
 						case 'r':
 							sortOrder = SORTORDER_TOPDOWN;
 							break;
@@ -461,7 +794,7 @@ main(int argc, char ** argv)
 							break;
 
 						default:
-							fatal("Bad ordering or sorting option");
+							return "Bad ordering or sorting option";
 					}
 				}
 
@@ -482,15 +815,22 @@ main(int argc, char ** argv)
 						break;
 
 					default:
-						fatal("Bad maximum");
+						return "Bad maximum";
 				}
 
 				break;
 
 			case 'p':
 				/*
-				 * Find parents only.
+				 * Race several search orders, or else
+				 * find parents only.
 				 */
+				if (strcmp(str, "ortfolio") == 0)
+				{
+					portfolio = TRUE;
+					break;
+				}
+
 				parent = TRUE;
 				break;
 
@@ -501,208 +841,254 @@ main(int argc, char ** argv)
 				allObjects = TRUE;
 				break;
 
-			case 'D':
+			case 'j':
 				/*
-				 * Turn on debugging output.
+				 * Set number of parallel workers.
 				 */
-				debug = TRUE;
+				workers = atoi(str);
 				break;
 
-			case 'R':
+			case 'e':
 				/*
-				 * Set rules.
+				 * Select the propagation engine.
 				 */
-				if (!setRules(str))
-					fatal("Bad rule string");
+				switch (*str++)
+				{
+					case 'c':
+						engine = ENGINE_CELL;
+						break;
+
+					case 'b':
+						engine = ENGINE_BIT;
+						break;
+
+					case 'd':
+						engine = ENGINE_DIFF;
+						break;
+
+					default:
+						return "Bad engine";
+				}
 
 				break;
 
-			default:
-				ttyClose();
+			case 'L':
+				/*
+				 * Learn from conflicts, keeping the given
+				 * number of learned clauses.
+				 */
+				learnLimit = atoi(str);
 
-				fprintf(stderr, "Unknown option -%c\n",
-					str[-1]);
+				if (learnLimit <= 0)
+					learnLimit = LEARN_LIMIT;
 
-				exit(1);
-		}
-	}
+				break;
 
-	if (parent &&
-		(rowTrans || colTrans || flipQuads || flipRows || flipCols))
-	{
-		fatal("Cannot specify translations or flips with -p");
-	}
+			case 'S':
+				/*
+				 * Restart the search using Luby's sequence
+				 * or geometrically growing numbers of
+				 * conflicts, optionally with a seed.
+				 */
+				if (*str == 'l')
+					restartKind = RESTART_LUBY;
+				else if (*str == 'g')
+					restartKind = RESTART_GEOM;
+				else
+					return "Restarts must be -Sl or -Sg";
 
-	if ((pointSym != 0) + (rowSym || colSym) + (fwdSym || bwdSym) > 1)
-		fatal("Conflicting symmetries specified");
+				str++;
+				restartUnit = RESTART_UNIT;
+				restartSeed = 1;
 
-	if ((fwdSym || bwdSym || flipFwd || flipBwd || flipQuads) && (rowMax != colMax))
-		fatal("Rows must equal cols with -sf, -sb, or -fq");
+				if (isdigit(*str))
+					restartUnit = strtol(str, (char **) &str, 10);
 
-	if ((rowTrans || colTrans) + (flipQuads != 0) > 1)
-		fatal("Conflicting translation or flipping specified");
+				if (*str == ',')
+					restartSeed = strtoul(str + 1, NULL, 10);
 
-	if ((rowTrans && flipRows) || (colTrans && flipCols))
-		fatal("Conflicting translation or flipping specified");
+				if (restartUnit <= 0)
+					return "Bad number of conflicts for restarts";
 
-	if ((useRow < 0) || (useRow > rowMax))
-		fatal("Bad row for -ur");
+				break;
 
-	if ((useCol < 0) || (useCol > colMax))
-		fatal("Bad column for -uc");
+			case 'P':
+				/*
+				 * Probe both states of the given number
+				 * of cells before each choice.
+				 */
+				probeLimit = atoi(str);
 
-    if (!noWait)
-    {
-	    if (!ttyOpen())
-		    fatal("Cannot initialize terminal");
-    }
+				if (probeLimit <= 0)
+					probeLimit = 1;
 
-	/*
-	 * Check for loading state from file or reading initial
-	 * object from file.
-	 */
-	if (loadFile)
-	{
-		if (loadState(loadFile) != OK)
-		{
-			ttyClose();
-			exit(1);
+				if (probeLimit > 9)
+					return "Probe count must be from 1 to 9";
+
+				break;
+
+			case 'U':
+				/*
+				 * Skip objects which were already found,
+				 * optionally sharing them through a file.
+				 */
+				uniqueObjects = TRUE;
+
+				if ((argc > 0) && (**argv != '-'))
+				{
+					argc--;
+					uniqueFile = *argv++;
+				}
+
+				break;
+
+			case 'H':
+				/*
+				 * Count the settings of each cell for
+				 * heatmaps, written to files with the
+				 * given prefix.
+				 */
+				if (!HEAT_FLAG)
+					return "Heatmaps are not compiled in";
+
+				heatFile = HEAT_FILE;
+
+				if ((argc > 0) && (**argv != '-'))
+				{
+					argc--;
+					heatFile = *argv++;
+				}
+
+				break;
+
+			case 'C':
+				/*
+				 * Run the objects which are found and
+				 * describe what they do in the output.
+				 */
+				classify = TRUE;
+				break;
+
+			case 'D':
+				/*
+				 * Trace the search, writing the latest
+				 * events to the given file.
+				 */
+				traceFile = TRACE_FILE;
+
+				if ((argc > 0) && (**argv != '-'))
+				{
+					argc--;
+					traceFile = *argv++;
+				}
+
+				break;
+
+			case 'R':
+				/*
+				 * Set rules.
+				 */
+				if (!setRules(str))
+					return "Bad rule string";
+
+				break;
+
+			default:
+				sprintf(optionBuf, "Unknown option -%c", str[-1]);
+
+				return optionBuf;
 		}
 	}
-	else
+
+	if (parent &&
+		(rowTrans || colTrans || flipQuads || flipRows || flipCols))
 	{
-		initCells();
+		return "Cannot specify translations or flips with -p";
+	}
 
-		if (initFile)
-		{
-			if (readFile(initFile) != OK)
-			{
-				ttyClose();
-				exit(1);
-			}
+	if ((pointSym != 0) + (rowSym || colSym) + (fwdSym || bwdSym) > 1)
+		return "Conflicting symmetries specified";
 
-			baseSet = nextSet;
-		}
-	}
+	if ((fwdSym || bwdSym || flipFwd || flipBwd || flipQuads) && (rowMax != colMax))
+		return "Rows must equal cols with -sf, -sb, or -fq";
 
-	/*
-	 * If we are looking for parents, then set the current generation
-	 * to the last one so that it can be input easily.  Then get the
-	 * commands to initialize the cells, unless we were told to not wait.
-	 */
-	if (parent)
-		curGen = genMax - 1;
+	if ((rowTrans || colTrans) + (flipQuads != 0) > 1)
+		return "Conflicting translation or flipping specified";
 
-	if (noWait)
-	{
-	    if (!quiet)
-		    printGen(0);
-    }
-	else
-		getCommands();
+	if ((rowTrans && flipRows) || (colTrans && flipCols))
+		return "Conflicting translation or flipping specified";
 
-	inited = TRUE;
+	if ((useRow < 0) || (useRow > rowMax))
+		return "Bad row for -ur";
 
-    /*
-     * Arm the output timers
-     */
-    if (dumpFreq)
-    {
-        if (timer_settime(tidDump, 0, &itsDump, NULL) == -1)
-        {
-            perror("timer_settime Dump failed");
-            exit(EXIT_FAILURE);
-        }
-    }
+	if ((useCol < 0) || (useCol > colMax))
+		return "Bad column for -uc";
 
-    if (timer_settime(tidView, 0, &itsView, NULL) == -1)
-    {
-        perror("timer_settime View failed");
-        exit(EXIT_FAILURE);
-    }
+	if ((workers > 1) && !noWait)
+		return "Parallel search requires -b or -ln";
 
-	/*
-	 * Initial commands are complete, now look for the object.
-	 */
-	while (TRUE)
-	{
-		if (curStatus == OK)
-		{
-			time(&startTime);
-			curStatus = search(noWait);
-			time(&end);
-			dif = end - startTime;
-			secToHMS(dif, timeBuf);
-        }
+	if ((workers > 1) && dumpFreq)
+		return "Cannot dump status with -j";
 
-//		if ((curStatus == FOUND) && useRow &&
-//			(rowInfo[useRow].onCount == 0))
-//		{
-//			curStatus = OK;
-//			continue;
-//		}
+	if ((workers > 1) && statsFile)
+		return "Cannot write statistics with -j";
 
-		if ((curStatus == FOUND) && !allObjects && subPeriods())
-		{
-			curStatus = OK;
-			continue;
-		}
+	if ((workers > 1) && heatFile)
+		return "Cannot write heatmaps with -j";
 
-		if (dumpFreq)
-        {
-            dumpState(dumpFile);
-        }
+	if ((workers > 1) && traceFile)
+		return "Cannot trace with -j";
 
-		quitOk = (curStatus == NOT_EXIST);
+	if (learnLimit && (engine != ENGINE_CELL))
+		return "Learning requires the cell engine";
 
-		curGen = 0;
+	if (splitFile && (splitCount <= 0))
+		return "Bad count for -split";
 
-		if (outputFile == NULL)
-		{
-			if (!noWait)
-			{
-				getCommands();
-				continue;
-			}
-		}
+	if (splitCount && (workers > 1))
+		return "Cannot split with -j";
 
-		/*
-		 * Here if results are going to a file.
-		 */
-		if (curStatus == FOUND)
-		{
-			curStatus = OK;
+	if (restartKind && (allObjects || (workers > 1)))
+		return "Cannot restart with -a or -j";
 
-			if (!quiet)
-			{
-				printGen(0);
-				ttyStatus("Object %ld found in%s.\n", ++foundCount, timeBuf);
-			}
+	if (portfolio && (allObjects || (workers > 1) || splitCount))
+		return "Cannot use -a, -j or -split with -portfolio";
 
-			writeGen(outputFile, TRUE);
-			if (noWait)
-			{
-			    if (allObjects)
-			        continue;
-			}
-			else
-			    continue;
-		}
+	if (portfolio && (dumpFreq || loadFile))
+		return "Cannot dump or load with -portfolio";
 
-		if (foundCount == 0)
-		{
-		    printf("Total time searched%s.\n", timeBuf);
-			fatal("No objects found.");
-        }
-		ttyClose();
+	return NULL;
+}
 
-		if (!quiet)
-		{
-			printf("Search completed, file \"%s\" contains %ld object%s\n",
-				outputFile, foundCount, (foundCount == 1) ? "" : "s");
-        }
-		exit(0);
+
+/*
+ * Set up the cells of a search whose options have been set, either by
+ * loading its state from a file, or by reading the initial object from
+ * a file if there is one.
+ * Returns OK on success, NOT_EXIST if the initial object is inconsistent,
+ * or ERROR on other failures.
+ */
+Status
+setupSearch(void)
+{
+	Status	status;
+
+	if (loadFile)
+		return loadState(loadFile);
+
+	initCells();
+
+	if (initFile)
+	{
+		status = readFile(initFile);
+
+		if (status != OK)
+			return status;
+
+		baseSet = nextSet;
 	}
+
+	return OK;
 }
 
 
@@ -799,6 +1185,40 @@ getCommands(void)
 				dumpState(cp);
 				break;
 
+			case 'h':
+				/*
+				 * Write the heatmap to files.
+				 */
+				cp = getStr(cp, "Write heatmap to files with prefix: ");
+
+				if (*cp)
+					writeHeat(cp);
+
+				break;
+
+			case 't':
+				/*
+				 * Write the trace to a file.
+				 */
+				cp = getStr(cp, "Write trace to file: ");
+
+				if (*cp)
+					writeTrace(cp);
+
+				break;
+
+			case 'T':
+				/*
+				 * Turn tracing on or off.
+				 */
+				if (tracing)
+					traceStop();
+				else
+					traceStart();
+
+				ttyStatus("Tracing is %s\n", tracing ? "on" : "off");
+				break;
+
 			case 'N':
 				/*
 				 * Find next object.
@@ -972,7 +1392,7 @@ getBackup(const char * cp)
 		if (blanksToo || (state == ON))
 			count--;
 
-		setState(cell, UNK);
+		setVar(cell, UNK);
 
 		if (go(cell, state, FALSE) != OK)
 		{
@@ -1258,10 +1678,52 @@ printGen(int gen)
 	int		count = 0, unkCount = 0;
 	const Cell *	cell;
 	const char *	msg;
+	char		learnBuf[160];
+	char		etaBuf[32];
+	double		eta;
 	time_t mark;
 	long dif;
 
 	curGen = gen;
+	learnBuf[0] = '\0';
+
+	if (learnLimit)
+	{
+		sprintf(learnBuf, " learnt %ld jumps %ld",
+			learnCount, jumpCount);
+	}
+
+	if (probeLimit)
+	{
+		sprintf(learnBuf + strlen(learnBuf), " probes %ld fixed %ld",
+			probeCount, probeFixed);
+	}
+
+	if (restartKind)
+	{
+		sprintf(learnBuf + strlen(learnBuf), " restarts %ld",
+			restartCount);
+	}
+
+	/*
+	 * Show how much of a search in progress is done and how long the
+	 * rest of it should take.
+	 */
+	if (inited && (curStatus != NOT_EXIST))
+	{
+		sprintf(learnBuf + strlen(learnBuf), " done %.1f%%",
+			searchDone() * 100);
+
+		eta = searchEta();
+
+		if (eta > ETA_MAX)
+			strcat(learnBuf, " eta forever");
+		else if (eta >= 0)
+		{
+			secToHMS((long) eta, etaBuf);
+			sprintf(learnBuf + strlen(learnBuf), " eta%s", etaBuf);
+		}
+	}
 
 	switch (curStatus)
 	{
@@ -1296,24 +1758,26 @@ printGen(int gen)
 	{
 	    if (curStatus == FOUND)
 	    {
-	        ttyPrintf("%s%s (gen %d, cells %d unk %d confl %ld)", msg, timeBuf, gen, count, unkCount, stepConfl);
+	        ttyPrintf("%s%s (gen %d, cells %d unk %d confl %ld%s)", msg, timeBuf, gen, count, unkCount, stepConfl, learnBuf);
 	    }
 	    else
 	    {
-	        ttyPrintf("%s (gen %d, cells %d unk %d confl %ld)", msg, gen, count, unkCount, stepConfl);
+	        ttyPrintf("%s (gen %d, cells %d unk %d confl %ld%s)", msg, gen, count, unkCount, stepConfl, learnBuf);
 	    }
 	}
 	else
 	{
 		if (curStatus == FOUND)
 	    {
-	        ttyPrintf("%s%s (rule %s, gen %d, cells %d unk %d confl %ld)",
-			msg, timeBuf, ruleString, gen, count, unkCount, stepConfl);
+	        ttyPrintf("%s%s (rule %s, gen %d, cells %d unk %d confl %ld%s)",
+			msg, timeBuf, ruleString, gen, count, unkCount, stepConfl,
+			learnBuf);
 	    }
 	    else
 	    {
-		    ttyPrintf("%s (rule %s, gen %d, cells %d unk %d confl %ld)",
-			msg, ruleString, gen, count, unkCount, stepConfl);
+		    ttyPrintf("%s (rule %s, gen %d, cells %d unk %d confl %ld%s)",
+			msg, ruleString, gen, count, unkCount, stepConfl,
+			learnBuf);
 		}
 	}
 
@@ -1367,7 +1831,7 @@ printGen(int gen)
 	if (bwdSym)
 		ttyPrintf(" -sb");
 
-	if (orderGens || orderWide || orderInvert || orderMiddle || (sortOrder != SORTORDER_DEFAULT))
+	if (orderGens || orderWide || orderInvert || orderMiddle || orderDynamic || (sortOrder != SORTORDER_DEFAULT))
 	{
 		ttyPrintf(" -o");
 
@@ -1383,6 +1847,9 @@ printGen(int gen)
 		if (orderMiddle)
 			ttyPrintf("m");
 
+		if (orderDynamic)
+			ttyPrintf("d");
+
 		if (sortOrder == SORTORDER_DIAG)
 			ttyPrintf("f");
 		else if (sortOrder == SORTORDER_BACKDIAG)
@@ -1430,7 +1897,7 @@ printGen(int gen)
 		ttyPrintf(" -v%d", viewFreq);
 
 	if (dumpFreq)
-		ttyPrintf(" -d%d %s", dumpFreq, dumpFile);
+		ttyPrintf(" -d%s%d %s", forkDumps ? "f" : "", dumpFreq, dumpFile);
 
 	if (outputFile)
 	{
@@ -1443,6 +1910,23 @@ printGen(int gen)
 			ttyPrintf(" [%d]", foundCount);
 	}
 
+	if (classify)
+		ttyPrintf(" -C");
+
+	if (statsFile)
+		ttyPrintf(" -stats %s", statsFile);
+
+	if (heatFile)
+		ttyPrintf(" -H %s", heatFile);
+
+	if (traceFile)
+		ttyPrintf(" -D %s", traceFile);
+
+	if (uniqueFile)
+		ttyPrintf(" -U %s", uniqueFile);
+	else if (uniqueObjects)
+		ttyPrintf(" -U");
+
 	ttyPrintf("\n");
 
     if (!blockOutput)
@@ -1542,6 +2026,19 @@ writeGen(const char * file, Bool append)
 	if (fp == stdout)
 		fprintf(fp, "#\n");
 
+	/*
+	 * Objects from a parallel search are not in the serial order,
+	 * so mark them as such.
+	 */
+	if (append && (workers > 1))
+		fprintf(fp, "#unordered\n");
+
+	/*
+	 * Describe what found objects really do when they are run.
+	 */
+	if (append && classify)
+		fprintf(fp, "#class %s\n", classifyObject(curGen));
+
 	/*
 	 * Now write out the bounded area.
 	 */
@@ -1590,117 +2087,344 @@ writeGen(const char * file, Bool append)
 
 /*
  * Dump the current state of the search in the specified file.
- * If no file is specified, it is asked for.
+ * If no file is specified, it is asked for.  A dump which is still
+ * being written by a forked copy of the process is finished first.
  */
 void
 dumpState(const char * file)
 {
-	FILE *		fp;
-	Cell **		set;
-	const Cell *	cell;
-	int		row;
-	int		col;
-	int		gen;
-	int **		param;
-
 	file = getStr(file, "Dump state to file: ");
 
 	if (*file == '\0')
 		return;
 
-	fp = fopen(file, "w");
+	if (dumpPid > 0)
+		reapDump(TRUE);
 
-	if (fp == NULL)
+	if (writeDump(file) != OK)
 	{
-		ttyStatus("Cannot create \"%s\"\n", file);
+		ttyStatus("Error writing \"%s\"\n", file);
 
 		return;
 	}
 
-	/*
-	 * Dump out the version so we can detect incompatible formats.
-	 */
-	fprintf(fp, "V %d\n", DUMP_VERSION);
+	ttyStatus("State dumped to \"%s\" (%.1f%% done)\n", file,
+		searchDone() * 100);
+	quitOk = TRUE;
+}
 
-	/*
-	 * Dump out the life rule if it is not the normal one.
-	 */
-	if (!isLife)
-		fprintf(fp, "R %s\n", ruleString);
 
-	/*
-	 * Dump out the parameter values.
-	 */
-	fprintf(fp, "P");
+/*
+ * Dump the current state of the search in the specified file from a
+ * forked copy of the process, so that the search goes on while the copy
+ * writes the file.  Only one such dump is made at a time, so this one
+ * is skipped if the previous one is still being written.  If the process
+ * cannot be forked, then the state is dumped directly.
+ */
+void
+snapshotState(const char * file)
+{
+	pid_t	pid;
 
-	for (param = paramTable; *param; param++)
-		fprintf(fp, " %d", **param);
+	if ((dumpPid > 0) && !reapDump(FALSE))
+		return;
 
-	fprintf(fp, "\n");
+	pid = fork();
 
-	/*
-	 * Dump out those cells which have a setting.
-	 */
-	set = setTable;
+	if (pid < 0)
+	{
+		dumpState(file);
+
+		return;
+	}
+
+	if (pid == 0)
+		_exit((writeDump(file) == OK) ? 0 : 1);
 
-	while (set != nextSet)
+	dumpPid = pid;
+	dumpPath = file;
+}
+
+
+/*
+ * Collect the forked copy of the process which is writing a dump,
+ * waiting for it if specified.  Reports an error if it failed.
+ * Returns TRUE if there is no longer a dump being written.
+ */
+static Bool
+reapDump(Bool wait)
+{
+	pid_t	pid;
+	int	status;
+
+	while (((pid = waitpid(dumpPid, &status, wait ? 0 : WNOHANG)) < 0) &&
+		(errno == EINTR))
 	{
-		cell = *set++;
+		continue;
+	}
+
+	if (pid == 0)
+		return FALSE;
+
+	if ((pid < 0) || !WIFEXITED(status) || WEXITSTATUS(status))
+		ttyStatus("Error writing \"%s\"\n", dumpPath);
+
+	dumpPid = 0;
+
+	return TRUE;
+}
+
+
+/*
+ * Write the current state of the search to the specified file.
+ * Only the cells which were chosen (or which cannot be deduced again
+ * from the earlier ones) are dumped, since loading the file deduces
+ * the rest again.  A checksum of all of the set cells is dumped so that
+ * loading can tell whether that worked.  The file is written in binary
+ * under a temporary name which is then renamed, so that an interrupted
+ * dump never destroys the previous one.  Nothing is printed, since this
+ * may be done by a forked copy of the process.
+ * Returns OK on success, ERROR on failure.
+ */
+Status
+writeDump(const char * file)
+{
+	FILE *		fp;
+	Cell **		set;
+	const Cell *	cell;
+	char *		tmpFile;
+	int		row;
+	int		col;
+	int		gen;
+	int		count;
+	int **		param;
+	int *		paramTable[] = PARAM_TABLE;
+
+	tmpFile = malloc(strlen(file) + 5);
+
+	if (tmpFile == NULL)
+		return ERROR;
 
-		fprintf(fp, "S %d %d %d %d %d\n", cell->row, cell->col,
-			cell->gen, cell->state, (cell->flags & FREECELL) ? 1 : 0);
+	sprintf(tmpFile, "%s.tmp", file);
+
+	fp = fopen(tmpFile, "wb");
+
+	if (fp == NULL)
+	{
+		free(tmpFile);
+
+		return ERROR;
 	}
 
 	/*
-	 * Dump out those cells which are being excluded from the search.
+	 * Dump out the version so we can detect incompatible formats.
 	 */
-	for (row = 1; row <= rowMax; row++)
-		for (col = 1; col < colMax; col++)
-			for (gen = 0; gen < genMax; gen++)
-	{
-		cell = findCell(row, col, gen);
+	fwrite(DUMP_MAGIC, 1, strlen(DUMP_MAGIC), fp);
+	putWord(fp, DUMP_VERSION);
 
-		if (cell->flags & CHOOSECELL)
-			continue;
+	/*
+	 * Dump out the life rule if it is not the normal one.
+	 */
+	count = (isLife ? 0 : strlen(ruleString));
+	putWord(fp, count);
+	fwrite(ruleString, 1, count, fp);
 
-		fprintf(fp, "X %d %d %d\n", row, col, gen);
-	}
+	/*
+	 * Dump out the parameter values.
+	 */
+	for (param = paramTable; *param; param++)
+		;
+
+	putWord(fp, param - paramTable);
+
+	for (param = paramTable; *param; param++)
+		putWord(fp, **param);
 
 	/*
 	 * Dump out those cells in generation 0 which are frozen.
 	 * It isn't necessary to remember frozen cells in other
 	 * generations since they will be copied from generation 0.
 	 */
+	count = 0;
+
+	for (row = 1; row <= rowMax; row++)
+		for (col = 1; col <= colMax; col++)
+			count += ((findCell(row, col, 0)->flags & FROZENCELL) != 0);
+
+	putWord(fp, count);
+
 	for (row = 1; row <= rowMax; row++)
-		for (col = 1; col < colMax; col++)
+		for (col = 1; col <= colMax; col++)
 	{
 		cell = findCell(row, col, 0);
 
 		if (cell->flags & FROZENCELL)
-			fprintf(fp, "F %d %d\n", row, col);
+			putWord(fp, cellNumber(cell));
 	}
 
 	/*
-	 * Finish up with the setting offsets and the final line.
+	 * Dump out those cells which are being excluded from the search.
 	 */
-	fprintf(fp, "T %ld %ld\n", baseSet - setTable, nextSet - setTable);
-	fprintf(fp, "E\n");
+	count = 0;
 
-	if (fclose(fp))
+	for (row = 1; row <= rowMax; row++)
+		for (col = 1; col <= colMax; col++)
+			for (gen = 0; gen < genMax; gen++)
+				count += !(findCell(row, col, gen)->flags & CHOOSECELL);
+
+	putWord(fp, count);
+
+	for (row = 1; row <= rowMax; row++)
+		for (col = 1; col <= colMax; col++)
+			for (gen = 0; gen < genMax; gen++)
 	{
-		ttyStatus("Error writing \"%s\"\n", file);
+		cell = findCell(row, col, gen);
 
-		return;
+		if (!(cell->flags & CHOOSECELL))
+			putWord(fp, cellNumber(cell));
 	}
 
-	ttyStatus("State dumped to \"%s\"\n", file);
-	quitOk = TRUE;
+	/*
+	 * Dump out those cells which have been chosen, along with their
+	 * states and whether they are still free.
+	 */
+	count = 0;
+
+	for (set = setTable; set != nextSet; set++)
+		count += (((*set)->flags & CHOSENCELL) != 0);
+
+	putWord(fp, count);
+
+	for (set = setTable; set != nextSet; set++)
+	{
+		cell = *set;
+
+		if (cell->flags & CHOSENCELL)
+			putWord(fp, cellWord(cell));
+	}
+
+	/*
+	 * Finish up with the setting offsets and the checksum.
+	 */
+	putWord(fp, baseSet - setTable);
+	putWord(fp, nextSet - setTable);
+	putWord(fp, dumpSum());
+
+	if (fclose(fp) || rename(tmpFile, file))
+	{
+		remove(tmpFile);
+		free(tmpFile);
+
+		return ERROR;
+	}
+
+	free(tmpFile);
+
+	return OK;
+}
+
+
+/*
+ * Return the number of a cell within the active area, counting rows
+ * first and then columns and then generations.
+ */
+static unsigned long
+cellNumber(const Cell * const cell)
+{
+	return ((unsigned long) cellGen(cell) * colMax + cellCol(cell) - 1) *
+		rowMax + cellRow(cell) - 1;
+}
+
+
+/*
+ * Return the cell with the specified number within the active area,
+ * or NULL_CELL if the number is out of range.
+ */
+static Cell *
+numberCell(unsigned long num)
+{
+	int	row;
+	int	col;
+
+	if (num >= (unsigned long) rowMax * colMax * genMax)
+		return NULL_CELL;
+
+	row = num % rowMax + 1;
+	num /= rowMax;
+	col = num % colMax + 1;
+
+	return findCell(row, col, num / colMax);
+}
+
+
+/*
+ * Return the word which describes the setting of a cell in a dump file.
+ * This is the number of the cell, its state, and whether it is free.
+ */
+static unsigned long
+cellWord(const Cell * const cell)
+{
+	return cellNumber(cell) * 4 + cell->state * 2 +
+		((cell->flags & FREECELL) ? 1 : 0);
+}
+
+
+/*
+ * Return a checksum of all of the set cells.  This does not depend on
+ * the order they were set in, since the engines can deduce cells in
+ * different orders.
+ */
+static unsigned long
+dumpSum(void)
+{
+	Cell **		set;
+	unsigned long	sum;
+
+	sum = nextSet - setTable;
+
+	for (set = setTable; set != nextSet; set++)
+		sum += (cellWord(*set) + 1) * 2654435761UL;
+
+	return sum & 0xffffffffUL;
+}
+
+
+/*
+ * Write a word to a dump file as four bytes, least significant first,
+ * so that dump files can be moved between machines.
+ */
+static void
+putWord(FILE * fp, unsigned long word)
+{
+	putc(word & 0xff, fp);
+	putc((word >> 8) & 0xff, fp);
+	putc((word >> 16) & 0xff, fp);
+	putc((word >> 24) & 0xff, fp);
+}
+
+
+/*
+ * Read a word written by putWord.  Reading past the end of the file
+ * leaves the end of file indicator set, which the caller checks.
+ */
+static unsigned long
+getWord(FILE * fp)
+{
+	unsigned long	word;
+
+	word = getc(fp) & 0xff;
+	word |= (getc(fp) & 0xffUL) << 8;
+	word |= (getc(fp) & 0xffUL) << 16;
+	word |= (getc(fp) & 0xffUL) << 24;
+
+	return word;
 }
 
 
 /*
  * Load a previously dumped state from a file.
- * Warning: Almost no checks are made for validity of the state.
+ * Text files written by older versions can still be loaded.
+ * Warning: Almost no checks are made for validity of a text state.
  * Returns OK on success, ERROR on failure.
  */
 static Status
@@ -1716,6 +2440,7 @@ loadState(const char * file)
 	Bool		free;
 	Cell *		cell;
 	int **		param;
+	int *		paramTable[] = PARAM_TABLE;
 	char		buf[LINE_SIZE];
 
 	file = getStr(file, "Load state from file: ");
@@ -1732,6 +2457,15 @@ loadState(const char * file)
 		return ERROR;
 	}
 
+	len = strlen(DUMP_MAGIC);
+
+	if ((fread(buf, 1, len, fp) == len) &&
+		(memcmp(buf, DUMP_MAGIC, len) == 0))
+	{
+		return loadBinary(fp, file);
+	}
+
+	rewind(fp);
 	buf[0] = '\0';
 	fgets(buf, LINE_SIZE, fp);
 
@@ -1745,7 +2479,7 @@ loadState(const char * file)
 
 	cp = &buf[1];
 
-	if (getNum(&cp, 0) != DUMP_VERSION)
+	if (getNum(&cp, 0) != DUMP_TEXT)
 	{
 		ttyStatus("Unknown version in state file \"%s\"\n", file);
 		fclose(fp);
@@ -1906,11 +2640,206 @@ loadState(const char * file)
 }
 
 
+/*
+ * Load the rest of a dumped state from a binary file whose magic string
+ * has been read, and close the file.  The chosen cells are set again in
+ * their original order, which deduces the other cells again, and the
+ * result is checked against the checksum.
+ * Returns OK on success, ERROR on failure.
+ */
+static Status
+loadBinary(FILE * fp, const char * file)
+{
+	Cell *		cell;
+	int **		param;
+	int *		paramTable[] = PARAM_TABLE;
+	unsigned long	word;
+	unsigned long	count;
+	unsigned long	base;
+	unsigned long	next;
+	State		state;
+	Bool		free;
+	char		buf[LINE_SIZE];
+
+	if (getWord(fp) != DUMP_VERSION)
+	{
+		ttyStatus("Unknown version in state file \"%s\"\n", file);
+		fclose(fp);
+
+		return ERROR;
+	}
+
+	/*
+	 * Set the life rules if they were specified.
+	 */
+	count = getWord(fp);
+
+	if (count >= LINE_SIZE)
+	{
+		ttyStatus("Bad Life rules in state file\n");
+		fclose(fp);
+
+		return ERROR;
+	}
+
+	if (count > 0)
+	{
+		buf[fread(buf, 1, count, fp)] = '\0';
+
+		if (!setRules(buf))
+		{
+			ttyStatus("Bad Life rules in state file\n");
+			fclose(fp);
+
+			return ERROR;
+		}
+	}
+
+	/*
+	 * Load up all of the parameters.  If parameters are missing at
+	 * the end, they are defaulted to zero, and extra ones are ignored.
+	 */
+	count = getWord(fp);
+
+	for (param = paramTable; *param; param++)
+	{
+		**param = ((count > 0) ? (int) getWord(fp) : 0);
+
+		if (count > 0)
+			count--;
+	}
+
+	for (; (count > 0) && !feof(fp); count--)
+		getWord(fp);
+
+	if (feof(fp))
+	{
+		ttyStatus("Missing parameters in state file\n");
+		fclose(fp);
+
+		return ERROR;
+	}
+
+	/*
+	 * Initialize the cells.
+	 */
+	initCells();
+
+	/*
+	 * Handle frozen cells first, since their loops affect what is
+	 * deduced from the chosen cells.
+	 */
+	for (count = getWord(fp); (count > 0) && !feof(fp); count--)
+	{
+		cell = numberCell(getWord(fp));
+
+		if ((cell == NULL_CELL) || (cellGen(cell) != 0))
+			break;
+
+		freezeCell(cellRow(cell), cellCol(cell));
+	}
+
+	if (count > 0)
+	{
+		ttyStatus("Bad frozen cell in state file\n");
+		fclose(fp);
+
+		return ERROR;
+	}
+
+	/*
+	 * Handle non-choosing cells.
+	 */
+	for (count = getWord(fp); (count > 0) && !feof(fp); count--)
+	{
+		cell = numberCell(getWord(fp));
+
+		if (cell == NULL_CELL)
+			break;
+
+		cell->flags &= ~CHOOSECELL;
+	}
+
+	if (count > 0)
+	{
+		ttyStatus("Bad excluded cell in state file\n");
+		fclose(fp);
+
+		return ERROR;
+	}
+
+	/*
+	 * Set the chosen cells again.  Cells which have already been
+	 * deduced from the earlier ones do not need setting again.
+	 */
+	for (count = getWord(fp); (count > 0) && !feof(fp); count--)
+	{
+		word = getWord(fp);
+		cell = numberCell(word / 4);
+		state = (word / 2) % 2;
+		free = word % 2;
+
+		if (cell == NULL_CELL)
+		{
+			ttyStatus("Bad cell in state file\n");
+			fclose(fp);
+
+			return ERROR;
+		}
+
+		if (cell->state == state)
+			continue;
+
+		if (proceed(cell, state, free) != OK)
+		{
+			ttyStatus(
+				"Inconsistently setting cell at r%d c%d g%d \n",
+				cellRow(cell), cellCol(cell), cellGen(cell));
+
+			fclose(fp);
+
+			return ERROR;
+		}
+	}
+
+	base = getWord(fp);
+	next = getWord(fp);
+	word = getWord(fp);
+
+	if (feof(fp) || ferror(fp))
+	{
+		ttyStatus("Missing end of state file\n");
+		fclose(fp);
+
+		return ERROR;
+	}
+
+	fclose(fp);
+
+	if ((next != newSet - setTable) || (base > next) ||
+		(word != dumpSum()))
+	{
+		ttyStatus("Cells deduced differ from state file\n");
+
+		return ERROR;
+	}
+
+	baseSet = &setTable[base];
+	nextSet = &setTable[next];
+
+	ttyStatus("State loaded from \"%s\"\n", file);
+	quitOk = TRUE;
+
+	return OK;
+}
+
+
 /*
  * Read a file containing initial settings for either gen 0 or the last gen.
  * If setAll is TRUE, both the ON and the OFF cells will be set.
  * If setDeep is TRUE, then OFF cells will be set deeply (in all generations).
- * Returns OK on success, ERROR on error.
+ * Returns OK on success, NOT_EXIST if the settings are inconsistent, or
+ * ERROR on other errors.
  */
 static Status
 readFile(const char * file)
@@ -1924,6 +2853,7 @@ readFile(const char * file)
 	int		minGen;
 	int		maxGen;
 	int		gen;
+	Bool		newRow;
 	State		state;
 	char		buf[LINE_SIZE];
 
@@ -1943,12 +2873,22 @@ readFile(const char * file)
 
 	activeGen = (parent ? (genMax - 1) : 0);
 	row = 0;
+	col = 0;
+	newRow = TRUE;
 
+	/*
+	 * Rows longer than the buffer are read in several pieces.
+	 */
 	while (fgets(buf, LINE_SIZE, fp))
 	{
-		row++;
+		if (newRow)
+		{
+			row++;
+			col = 0;
+		}
+
+		newRow = (strchr(buf, '\n') != NULL);
 		cp = buf;
-		col = 0;
 
 		while (*cp && (*cp != '\n'))
 		{
@@ -2036,7 +2976,7 @@ readFile(const char * file)
 
 					fclose(fp);
 
-					return ERROR;
+					return NOT_EXIST;
 				}
 			}
 		}
@@ -2292,6 +3232,8 @@ usage(void)
 	"",
 	"lifesrc -r# -c# -g# [other options]",
 	"lifesrc -l[n] file -v# -o# file -d# file",
+	"lifesrc --campaign dir -j# -d# -g# [other options]",
+	"lifesrc --decode file",
 	"",
 	"   -r   Number of rows",
 	"   -c   Number of columns",
@@ -2308,6 +3250,7 @@ usage(void)
 	"   -sp  Enforce symmetry around central point",
 	"   -sf  Enforce symmetry on forward diagonal",
 	"   -sb  Enforce symmetry on backward diagonal",
+	"   -sn  Find all reflections and rotations of objects",
 	"   -nc  Near N cells of live cells in previous columns for generation 0",
 	"   -wc  Maximum width of live cells in each column for generation 0",
 	"   -mt  Maximum total live cells for generation 0",
@@ -2320,6 +3263,7 @@ usage(void)
 	"   -ow  Set search order to find wide objects first",
 	"   -og  Set search order to examine all gens in a column before next column",
 	"   -om  Set search order to examine from middle column outwards",
+	"   -od  Set search order to examine the most constrained cell next",
 	"   -or  Set search order to examine from top to bottom",
 	"   -oc  Set search order to examine from left to right",
 	"   -of  Set search order to examine from top left forward diagonal",
@@ -2328,6 +3272,7 @@ usage(void)
 	"   -a   Find all objects (even those with subPeriods)",
 	"   -v   View object every N million searches",
 	"   -d   Dump status to file every N million searches",
+	"   -df  Dump status from a forked copy while searching goes on",
 	"   -l   Load status from file",
 	"   -ln  Load status without entering command mode",
 	"   -b   Batch. Don't enter command mode",
@@ -2336,6 +3281,21 @@ usage(void)
 	"   -id  Read initial object setting OFF cells deeply (all gens)",
 	"   -o   Output objects to file (appending) every N columns",
 	"   -R   Use Life rules specified by born,live values",
+	"   -C   Run found objects and describe them in the output file",
+	"   -H   Count settings of cells, writing heatmaps to files (prefix)",
+	"   -D   Trace the latest events of the search, writing them to file",
+	"   -U   Skip objects already found in any phase or orientation (file)",
+	"   -j   Search using N parallel worker processes (objects unordered)",
+	"   -split  Split search into N parts dumped to files prefix.1 to prefix.N",
+	"   -stats  Append statistics to a file as JSON lines every view interval",
+	"   -portfolio  Race several search orders and report the winner",
+	"   -ec  Propagate settings one cell at a time (default)",
+	"   -eb  Propagate settings a whole column at a time using bit masks",
+	"   -ed  Propagate with both engines and check that they agree",
+	"   -L   Learn from conflicts, keeping N learned clauses (default 1000)",
+	"   -P   Probe both states of N cells (1-9) near each choice first",
+	"   -Sl  Restart after Luby's sequence times N conflicts (-SlN,seed)",
+	"   -Sg  Restart after N conflicts, growing by half each time (-SgN,seed)",
 	NULL
 	};
 
@@ -7,58 +7,76 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <signal.h>
 
 #include "state.h"
 
 
 /*
- * Maximum dimensions of the search
+ * Limits of the search.  The numbers of rows, columns and generations
+ * are only limited by memory, since all tables are sized for the search.
  */
-#define	ROW_MAX		49	/* maximum rows for search rectangle */
-#define	COL_MAX		132	/* maximum columns for search rectangle */
-#define	GEN_MAX		8	/* maximum number of generations */
 #define	TRANS_MAX	4	/* largest translation value allowed */
 
 
 /*
  * Build options
  */
-#ifndef DEBUG_FLAG
-#define	DEBUG_FLAG	0	/* nonzero for debugging features */
+#ifndef HEAT_FLAG
+#define	HEAT_FLAG	1	/* nonzero for counting settings of each cell */
 #endif
 
 
 /*
  * Other definitions
  */
-#define	DUMP_VERSION	7		/* version of dump file */
+#define	DUMP_VERSION	8		/* version of dump file */
+#define	DUMP_TEXT	7		/* version of old text dump file */
+#define	DUMP_MAGIC	"LSRCDUMP"	/* start of dump file */
 
-#define	ALLOC_SIZE	50000		/* chunk size for cell allocation */
 #define	VIEW_MULT	1000000		/* viewing frequency multiplier */
 #define	DUMP_MULT	1000000		/* dumping frequency multiplier */
 #define	DUMP_FILE	"lifesrc.dmp"	/* default dump file name */
+#define	SPLIT_FILE	"split"		/* default prefix of split files */
+#define	HEAT_FILE	"heat"		/* default prefix of heatmap files */
+#define	TRACE_FILE	"lifesrc.trc"	/* default trace file name */
 #define	LINE_SIZE	132		/* size of input lines */
+#define	ETA_MAX		(1000.0 * 86400)	/* longest time left shown */
 
-#define	MAX_CELLS	((COL_MAX + 2) * (ROW_MAX + 2) * GEN_MAX)
-#define	AUX_CELLS	(TRANS_MAX * (COL_MAX + ROW_MAX + 4) * 2)
+#define	ENGINE_CELL	0	/* propagate one cell at a time */
+#define	ENGINE_BIT	1	/* propagate whole columns as bit masks */
+#define	ENGINE_DIFF	2	/* run both engines and compare them */
+#define	LEARN_LIMIT	1000	/* default number of learned clauses */
+
+#define	RESTART_NONE	0	/* never restart the search */
+#define	RESTART_LUBY	1	/* restart after Luby's sequence of conflicts */
+#define	RESTART_GEOM	2	/* restart after geometrically more conflicts */
+#define	RESTART_UNIT	1000	/* default conflicts for the first restart */
+
+#define	SYM_FIND	(-1)	/* find the symmetries to break when searching */
 
 /*
  * Flag bits
  */
-typedef unsigned short cellFlags;
+typedef unsigned char cellFlags;
 
 #define FREECELL	((cellFlags) 0x01) /* this cell still has free choice */
 #define FROZENCELL	((cellFlags) 0x02) /* this cell is frozen in all gens */
 #define CHOOSECELL	((cellFlags) 0x04) /* can choose this cell if unknown */
+#define CHOSENCELL	((cellFlags) 0x08) /* set by a choice, not by deduction */
+#define SAVEDCELL	((cellFlags) 0x10) /* has a state saved by a restart */
+#define SAVEDON		((cellFlags) 0x20) /* the saved state is ON */
+#define LOOPCELL	((cellFlags) 0x40) /* belongs to a loop of cells */
 
 /*
- * Debugging macros
+ * Whether the settings of each cell are being counted for heatmaps,
+ * which is always false when that is compiled out.
  */
-#if DEBUG_FLAG
-#define	DPRINTF(fmt, ...)   if (debug) printf(fmt, ##__VA_ARGS__ )
+#if HEAT_FLAG
+#define	heatCounting	(heatTable != NULL)
 #else
-#define	DPRINTF(fmt, ...)
+#define	heatCounting	FALSE
 #endif
 
 #define	isBlank(ch)	(((ch) == ' ') || ((ch) == '\t'))
@@ -89,6 +107,7 @@ typedef	unsigned int	Status;
  */
 typedef	struct
 {
+	int	setCount;	/* number of cells which are set */
 	int	onCount;	/* number of cells which are set on */
 } RowInfo;
 
@@ -106,42 +125,64 @@ typedef struct
 
 /*
  * Information about one cell of the search.
+ * Only the values which are used in the inner loops of the search are
+ * kept here, so that a cell is small and the cells of one generation are
+ * packed together.  The cells are stored in one table, one plane per
+ * generation, with the rows of each column adjacent.  Each plane has a
+ * border of CELL_PAD dead cells around the boundary cells so that the
+ * neighbors of a cell are found by simple offsets.  The less used values
+ * are kept in parallel tables indexed by the offset of the cell.
  */
 typedef	struct Cell Cell;
 
 struct Cell
 {
 	State		state;		/* current state */
-    cellFlags	flags;		/* the (C)hoose, fro(Z)en, and (F)ree flags */
-							/*  in a bitfield : 0x00000CZF */
-	short		gen;		/* generation number of this cell */
-	short		row;		/* row of this cell */
-	short		col;		/* column of this cell */
-	int			sumNear;	/* sum of states of neighbor cells */
-	int			index;
-	Cell *		past;		/* cell in past at this location */
-	Cell *		future;		/* cell in future at this location */
-	Cell *		cul;		/* cell to up and left */
-	Cell *		cu;		/* cell to up */
-	Cell *		cur;		/* cell to up and right */
-	Cell *		cl;		/* cell to left */
-	Cell *		cr;		/* cell to right */
-	Cell *		cdl;		/* cell to down and left */
-	Cell *		cd;		/* cell to down */
-	Cell *		cdr;		/* cell to down and right */
-	Cell *		loop;		/* next cell in this same loop */
+	cellFlags	flags;		/* the (C)hoose, fro(Z)en, and (F)ree flags */
+	int		sumNear;	/* sum of states of neighbor cells */
 };
 
+#define	CELL_PAD	(TRANS_MAX + 1)	/* dead cells around the boundary */
+
+#define	cellOffset(cell)	((int) ((cell) - cellTable))
+#define	cellGen(cell)	(cellOffset(cell) / genStride)
+#define	cellCol(cell)	(cellOffset(cell) % genStride / colStride - CELL_PAD)
+#define	cellRow(cell)	(cellOffset(cell) % genStride % colStride - CELL_PAD)
+
+#define	cellUL(cell)	((cell) - colStride - 1)	/* up and left */
+#define	cellU(cell)	((cell) - 1)			/* up */
+#define	cellUR(cell)	((cell) + colStride - 1)	/* up and right */
+#define	cellL(cell)	((cell) - colStride)		/* left */
+#define	cellR(cell)	((cell) + colStride)		/* right */
+#define	cellDL(cell)	((cell) - colStride + 1)	/* down and left */
+#define	cellD(cell)	((cell) + 1)			/* down */
+#define	cellDR(cell)	((cell) + colStride + 1)	/* down and right */
+
+#define	cellPast(cell)	(cellTable + pastTable[cellOffset(cell)])
+#define	cellFuture(cell)	(cellTable + futureTable[cellOffset(cell)])
+#define	cellLoop(cell)	(loopTable[cellOffset(cell)])	/* or -1 if none */
+#define	cellVar(cell)	(cellTable + varTable[cellOffset(cell)])
+#define	cellIndex(cell)	(indexTable[cellOffset(cell)])	/* or -1 if none */
+
 #define	NULL_CELL	((Cell *) 0)
 
 
+/*
+ * All of the state of a search is kept separately by each thread, so that
+ * several searches can be run in one process by the calls in lifeapi.h.
+ * Static data in the other modules which belongs to a search is declared
+ * the same way.
+ */
+#define	SEARCH_LOCAL	__thread
+
+
 /*
  * Declare this macro so that by default the variables are defined external.
- * In the main program, this is defined as a null value so as to actually
- * define the variables.
+ * In the main program, this is defined as just SEARCH_LOCAL so as to
+ * actually define the variables.
  */
 #ifndef	EXTERN
-#define	EXTERN	extern
+#define	EXTERN	extern SEARCH_LOCAL
 #endif
 
 
@@ -181,10 +222,12 @@ EXTERN	Bool	orderWide;	/* ordering tries to find wide objects */
 EXTERN	Bool	orderGens;	/* ordering tries all gens first */
 EXTERN	Bool	orderInvert;	/* Inverts direction of non-wide orderings */
 EXTERN	Bool	orderMiddle;	/* ordering tries middle columns first */
+EXTERN	Bool	orderDynamic;	/* ordering picks most constrained cell */
 EXTERN	Bool	followGens;	/* try to follow setting of other gens */
-EXTERN	State   chooseUnknown;  /* First choice for unknown cell, either ON or OFF */
+EXTERN	int     chooseUnknown;  /* First choice for unknown cell, either ON or OFF */
 EXTERN  long stepConfl; /* step counter for one Proceed-Backup action */
 EXTERN  int sortOrder; /* sort direction */
+EXTERN	int	symMask;	/* grid symmetries broken, or SYM_FIND */
 
 /*
  * These values are not affected when dumping and loading since they
@@ -192,7 +235,7 @@ EXTERN  int sortOrder; /* sort direction */
  * They are either setTable on the command line or are computed.
  */
 EXTERN	Bool	quiet;		/* don't output */
-EXTERN	Bool	debug;		/* enable debugging output (if compiled so) */
+EXTERN	Bool	tracing;	/* events of the search are being traced */
 EXTERN	Bool	quitOk;		/* ok to quit without confirming */
 EXTERN	Bool	inited;		/* initialization has been done */
 EXTERN	State	bornRules[9];	/* rules for whether a cell is to be born */
@@ -203,43 +246,96 @@ EXTERN	int	outputLastCols;	/* last number of columns output */
 EXTERN	int	cellCount;	/* number of live cells in generation 0 */
 EXTERN	int	dumpFreq;	/* how often to perform dumps */
 EXTERN	sig_atomic_t	dumpFlag;	/* sigaction flag for dumps */
+EXTERN	Bool	forkDumps;	/* dump from a forked copy of the process */
 EXTERN	int	viewFreq;	/* how often to view results */
 EXTERN	sig_atomic_t	viewFlag;	/* sigaction flag for viewing */
+EXTERN	sig_atomic_t	statsFlag;	/* sigaction flag for statistics */
+EXTERN	sig_atomic_t	heatFlag;	/* sigaction flag for heatmaps */
+EXTERN	sig_atomic_t	traceFlag;	/* sigaction flag for the trace */
+EXTERN	sig_atomic_t	cancelFlag;	/* set to stop the search */
 EXTERN	char *	dumpFile;	/* dump file name */
+EXTERN	int	splitCount;	/* number of parts to split the search into */
+EXTERN	char *	splitFile;	/* prefix of the names of the split files */
 EXTERN	char *	outputFile;	/* file to output results to */
+EXTERN	char *	statsFile;	/* file to append statistics to */
+EXTERN	char *	heatFile;	/* prefix of the heatmap files */
+EXTERN	char *	traceFile;	/* file to write the trace to */
+EXTERN	long	foundCount;	/* number of objects found */
+EXTERN	Bool	uniqueObjects;	/* skip objects which were already found */
+EXTERN	char *	uniqueFile;	/* file of the objects already found */
+EXTERN	Bool	classify;	/* describe objects written to the output */
+EXTERN	int	workers;	/* number of parallel search workers */
+EXTERN	Bool	portfolio;	/* race several search orders */
+EXTERN	volatile int *	stealFlag;	/* set when idle workers want work */
+EXTERN	int	engine;		/* propagation engine to use */
+EXTERN	int	learnLimit;	/* number of learned clauses to keep */
+EXTERN	long	learnCount;	/* number of clauses learned */
+EXTERN	long	jumpCount;	/* number of choices cleared by backjumping */
+EXTERN	int	probeLimit;	/* number of cells to probe before a choice */
+EXTERN	long	probeCount;	/* number of cells probed */
+EXTERN	long	probeFixed;	/* number of cells set by probing */
+EXTERN	int	restartKind;	/* when to restart the search */
+EXTERN	long	restartUnit;	/* conflicts for the first restart */
+EXTERN	unsigned int	restartSeed;	/* seed for the orders after restarts */
+EXTERN	long	restartCount;	/* number of restarts done */
+EXTERN	long	nodeCount;	/* number of cells chosen or reversed */
+EXTERN	long	propCount;	/* number of cells set by propagating */
+EXTERN	long	maxDepth;	/* largest number of cells set at once */
+EXTERN	unsigned long *	heatTable;	/* counts of the settings of each cell */
+EXTERN	int	reasonKind;	/* why cells are currently being set */
+EXTERN	Cell *	reasonCell;	/* cell giving the current reason */
 
 
 /*
  * Data about all of the cells.
  */
-EXTERN	Cell *	setTable[MAX_CELLS];	/* table of cells whose value is set */
+EXTERN	Cell **	setTable;	/* table of cells whose value is set */
 EXTERN	Cell **	newSet;		/* where to add new cells into setting table */
 EXTERN	Cell **	nextSet;	/* next cell in setting table to examine */
 EXTERN	Cell **	baseSet;	/* base of changeable part of setting table */
 EXTERN	Cell *	fullSearchList;	/* complete list of cells to search */
-EXTERN	RowInfo	rowInfo[ROW_MAX];	/* information about rows of gen 0 */
-EXTERN	ColInfo	colInfo[COL_MAX];	/* information about columns of gen 0 */
+EXTERN	Cell *	cellTable;	/* table of all cells */
+EXTERN	int *	pastTable;	/* offset of cell in past for each cell */
+EXTERN	int *	futureTable;	/* offset of cell in future for each cell */
+EXTERN	int *	loopTable;	/* offset of next cell in same loop */
+EXTERN	int *	varTable;	/* offset of the cell standing for its loop */
+EXTERN	int *	indexTable;	/* position of each cell in search list */
+EXTERN	int	colStride;	/* offset between adjacent columns */
+EXTERN	int *	reasonTable;	/* why each cell was set, for learning */
+EXTERN	int *	trailTable;	/* position of each cell in setting table */
+EXTERN	int	genStride;	/* offset between adjacent generations */
+EXTERN	RowInfo *	rowInfo;	/* information about rows of gen 0 */
+EXTERN	ColInfo *	colInfo;	/* information about columns of gen 0 */
 EXTERN	int	fullColumns;	/* columns in gen 0 which are fully set */
 
 
 /*
  * Global procedures
  */
+extern	const char *	setOptions(int, char **);
+extern	Status	setupSearch(void);
+extern	void	freeCells(void);
 extern	void	getCommands(void);
 extern	void	initCells(void);
 extern	void	printGen(int);
 extern	void	writeGen(const char *, Bool);
 extern	void	dumpState(const char *);
+extern	Status	writeDump(const char *);
+extern	void	snapshotState(const char *);
 extern	void	adjustNear(Cell *, int);
 extern	Status	search(const Bool);
 extern	Status	proceed(Cell *, State, Bool);
 extern	Status	go(Cell *, State, Bool);
 extern	Status	setCell(Cell * const , const State, const Bool);
 extern	Cell *	findCell(int, int, int);
+extern	Cell *	nextChoice(State *);
+extern	Cell *	mapCell(const Cell *, Bool);
 extern	Cell *	backup(void);
 extern	Bool	subPeriods(void);
+extern	Bool	acceptObject(void);
 extern	void	loopCells(Cell *, Cell *);
 extern	void	fatal(const char *);
+extern	void	alarm_handler(const int);
 extern	Bool	ttyOpen(void);
 extern	Bool	ttyCheck(void);
 extern	Bool	ttyRead(const char *, char *, int);
@@ -7,10 +7,10 @@
  */
 
 /*
- * Define this as a null value so as to define the global variables
+ * Define this without extern so as to define the global variables
  * defined in lifesrc.h here.
  */
-#define EXTERN
+#define EXTERN SEARCH_LOCAL
 
 #include "lifesrc.h"
 #include "state.h"
@@ -21,6 +21,15 @@
 #include "description.h"
 #include "sortorder.h"
 #include "setstate.h"
+#include "parallel.h"
+#include "bitengine.h"
+#include "learn.h"
+#include "dynorder.h"
+#include "leader.h"
+#include "stats.h"
+#include "heatmap.h"
+#include "trace.h"
+#include "unique.h"
 
 /*
  * Table of state values.
@@ -34,7 +43,7 @@ static State states[nStates] = {OFF, ON, UNK};
  * this table determines the state of the cell in the next generation.
  * The table is indexed by the descriptor value of a cell.
  */
-static State transit[1024];
+static SEARCH_LOCAL State transit[1024];
 
 
 /*
@@ -44,36 +53,62 @@ static State transit[1024];
  * in the previous generation.
  * The table is indexed by the descriptor value of a cell.
  */
-static Flags implic[1024];
+static SEARCH_LOCAL Flags implic[1024];
 
 
 /*
  * Other local data.
  */
-static int newCellCount; /* cells ready for allocation */
-static int auxCellCount; /* cells in auxillary table */
-static int searchIdx;
-static int searchCount;
-static Cell *  newCells; /* cells ready for allocation */
-static Cell *  deadCell; /* boundary cell value */
-static Cell ** searchList; /* current list of cells to search */
-static Cell *  cellTable[MAX_CELLS]; /* table of usual cells */
-static Cell *  auxTable[AUX_CELLS]; /* table of auxillary cells */
+static SEARCH_LOCAL int searchIdx;
+static SEARCH_LOCAL int searchCount;
+static SEARCH_LOCAL int cellCountAll; /* number of cells in the cell table */
+static SEARCH_LOCAL Cell * firstGenEnd; /* end of the cells of generation 0 */
+static SEARCH_LOCAL Cell * lastGenStart; /* start of the cells of the last generation */
+static SEARCH_LOCAL Cell ** searchList; /* current list of cells to search */
+static SEARCH_LOCAL unsigned int * probeTable; /* states set by the last probe of ON */
+static SEARCH_LOCAL unsigned int probeStamp; /* stamp of the current probe */
+static SEARCH_LOCAL int * probeList; /* cells and states set by both probes */
+static SEARCH_LOCAL int * periodGens; /* generations compared for sub-periods */
+static SEARCH_LOCAL int periodCount; /* number of such generations */
+static SEARCH_LOCAL globals_struct orderGlobals; /* settings for sorting the search list */
+static SEARCH_LOCAL Bool symWhole; /* symmetry applies to the whole search */
+static SEARCH_LOCAL long restartAt; /* conflicts at which to restart next */
+static SEARCH_LOCAL long restartBudget; /* conflicts allowed since the last restart */
+static SEARCH_LOCAL unsigned int randState; /* state of the random numbers for restarts */
 
 
 /*
  * Local procedures
  */
 static void initSearchOrder(void);
-static void linkCell(Cell *);
 static State choose(const Cell *);
 static Cell * symCell(const Cell *);
-static Cell * mapCell(const Cell *, Bool);
-static Cell * allocateCell(void);
+static void allocateCells(void);
 static Cell * getNormalUnknown(void);
-static Status consistify(Cell * const);
+static Status consistify(Cell * const, Cell * const);
+static Status consistifyFuture(Cell * const);
 static Status consistify10(Cell * const);
 static Status examineNext(void);
+static void backjump(Cell ** const);
+static void restart(void);
+static void shuffleTies(void);
+static long luby(long);
+static Status probe(Cell ** const);
+static Status probeCell(Cell * const, const Bool);
+static void undoProbe(Cell ** const, Cell ** const);
+static Status setLoop(Cell * const, const State, const Bool);
+static Status checkVar(Cell * const, const State);
+static Status checkLimits(const Cell * const, const State);
+static Bool wholeSymmetry(void);
+static Bool sameVar(const Cell * const, const Cell * const);
+static Bool symLoop(const Cell * const);
+static int varIndex(const Cell * const);
+static Bool hasNear(const int, const int);
+static Bool widthOk(const int, const int);
+static Bool isPrime(const int);
+static Status propagate(void);
+static unsigned long setSum(Cell ** const);
+static Status diffPropagate(void);
 static int getDesc(const Cell * const);
 
 
@@ -88,7 +123,6 @@ initCells(void)
     int row;
     int col;
     int gen;
-    int i;
     Bool edge;
     Cell * cell;
     Cell * cell2;
@@ -96,32 +130,31 @@ initCells(void)
     /*
      * Check whether valid parameters have been set.
      */
-    if ((rowMax <= 0) || (rowMax > ROW_MAX))
+    if (rowMax <= 0)
         fatal("Row number out of range");
 
-    if ((colMax <= 0) || (colMax > COL_MAX))
+    if (colMax <= 0)
         fatal("Column number out of range");
 
-    if ((genMax <= 0) || (genMax > GEN_MAX))
+    if (genMax <= 0)
         fatal("Generation number out of range");
 
+    if ((double) (rowMax + 2 + CELL_PAD * 2) *
+        (colMax + 2 + CELL_PAD * 2) * genMax > INT_MAX / 2)
+    {
+        fatal("Search area too large");
+    }
+
     if ((rowTrans < -TRANS_MAX) || (rowTrans > TRANS_MAX))
         fatal("Row translation number out of range");
 
     if ((colTrans < -TRANS_MAX) || (colTrans > TRANS_MAX))
         fatal("Column translation number out of range");
 
-    /*
-     * The first allocation of a cell MUST be deadCell.
-     * Then allocate the cells in the cell table.
-     */
-    deadCell = allocateCell();
-
-    for (i = 0; i < MAX_CELLS; i++)
-        cellTable[i] = allocateCell();
+    allocateCells();
 
     /*
-     * Link the cells together.
+     * Set the states of the cells.
      */
     for (col = 0; col <= colMax+1; col++)
     {
@@ -133,33 +166,17 @@ initCells(void)
                     (row > rowMax) || (col > colMax));
 
                 cell = findCell(row, col, gen);
-                cell->gen = gen;
-                cell->row = row;
-                cell->col = col;
-                cell->flags |= CHOOSECELL;
 
                 /*
                  * If this is not an edge cell, then its state
-                 * is unknown and it needs linking to its
-                 * neighbors.
+                 * is unknown.
                  */
                 if (!edge)
                 {
-                    linkCell(cell);
                     setState(cell, UNK);
                     cell->flags |= FREECELL;
                 }
 
-                /*
-                 * Map time forwards and backwards,
-                 * wrapping around at the ends.
-                 */
-                cell->past = findCell(row, col,
-                    (gen+genMax-1) % genMax);
-
-                cell->future = findCell(row, col,
-                    (gen+1) % genMax);
-
                 /*
                  * If this is not an edge cell, and
                  * there is some symmetry, then put
@@ -175,6 +192,40 @@ initCells(void)
         }
     }
 
+    /*
+     * No cells of generation 0 are set yet, so clear the counts which
+     * were disturbed by making the cells unknown.
+     */
+    for (row = 0; row <= rowMax+1; row++)
+    {
+        rowInfo[row].setCount = 0;
+        rowInfo[row].onCount = 0;
+    }
+
+    for (col = 0; col <= colMax+1; col++)
+    {
+        colInfo[col].setCount = 0;
+        colInfo[col].onCount = 0;
+        colInfo[col].sumPos = 0;
+    }
+
+    cellCount = 0;
+    fullColumns = 0;
+
+    /*
+     * If generation 0 is the same as a generation whose number divides
+     * the period, then it is also the same as the generation which is
+     * the period divided by some prime factor of it.  So only those
+     * generations need to be compared to find sub-periods.
+     */
+    periodCount = 0;
+
+    for (gen = genMax / 2; gen >= 1; gen--)
+    {
+        if (((genMax % gen) == 0) && isPrime(genMax / gen))
+            periodGens[periodCount++] = gen;
+    }
+
     /*
      * If there is a non-standard mapping between the last generation
      * and the first generation, then change the future and past pointers
@@ -188,17 +239,18 @@ initCells(void)
             {
                 cell = findCell(row, col, genMax - 1);
                 cell2 = mapCell(cell, TRUE);
-                cell->future = cell2;
-                cell2->past = cell;
+                futureTable[cellOffset(cell)] = cellOffset(cell2);
+                pastTable[cellOffset(cell2)] = cellOffset(cell);
 
                 cell = findCell(row, col, 0);
                 cell2 = mapCell(cell, FALSE);
-                cell->past = cell2;
-                cell2->future = cell;
+                pastTable[cellOffset(cell)] = cellOffset(cell2);
+                futureTable[cellOffset(cell2)] = cellOffset(cell);
             }
         }
     }
 
+    symWhole = wholeSymmetry();
     initSearchOrder();
 
     newSet = setTable;
@@ -206,11 +258,27 @@ initCells(void)
     baseSet = setTable;
 
     stepConfl = 0;
+    restartCount = 0;
+    nodeCount = 0;
+    propCount = 0;
+    maxDepth = 0;
+    restartBudget = restartUnit;
+    restartAt = restartUnit;
+    randState = restartSeed;
     curGen = 0;
     curStatus = OK;
     initNextState(bornRules, liveRules);
     initTransit(states, transit);
     initImplic(states, implic);
+
+    if (engine != ENGINE_CELL)
+        bitInit();
+
+    if (learnLimit)
+        learnInit();
+
+    if (heatFile)
+        heatInit();
 }
 
 
@@ -227,7 +295,6 @@ initSearchOrder(void)
     int col;
     int gen;
     int count;
-    Cell * table[MAX_CELLS];
     globals_struct g;
     
     g.colMax = colMax;
@@ -242,6 +309,12 @@ initSearchOrder(void)
      * Make a table of cells that will be searched.
      * Ignore cells that are not relevant to the search due to symmetry.
      */
+    free(searchList);
+    searchList = (Cell **) malloc(sizeof(Cell *) * (rowMax * colMax * genMax + 1));
+
+    if (searchList == NULL)
+        fatal("Cannot allocate search list");
+
     searchCount = 0;
 
     for (gen = 0; gen < genMax; gen++)
@@ -260,27 +333,27 @@ initSearchOrder(void)
         if (bwdSym && (col > row ))
             continue;
 
-        table[searchCount++] = findCell(row, col, gen);
+        searchList[searchCount++] = findCell(row, col, gen);
     }
 
     /*
      * Now sort the table based on our desired search order.
      */
-    qsort_r((char *) table, searchCount, sizeof(Cell *), &orderSortFunc, &g);
+    qsort_r((char *) searchList, searchCount, sizeof(Cell *), &orderSortFunc, &g);
+    orderGlobals = g;
 
     /*
-     * Finally build the search list from the table elements in the
-     * final order.
+     * Finally number the cells in the search list by their places in it.
      */
-    searchList = (Cell **) malloc(sizeof(Cell *) * (searchCount + 1));
-
     for (int i = 0; i < searchCount; i++)
-    {
-        searchList[i] = table[i];
-        searchList[i]->index = i;
-    }
+        cellIndex(searchList[i]) = i;
+
     searchList[searchCount] = NULL;
     searchIdx = 0;
+    leaderInit(searchList, searchCount);
+
+    if (orderDynamic)
+        dynInit(searchList, searchCount);
 }
 
 
@@ -294,49 +367,293 @@ initSearchOrder(void)
 Status
 setCell(Cell * const cell, const State state, const Bool free)
 {
-    if (cell->state == state)
-    {
-        DPRINTF("setCell %d %d %d to state %s already set\n",
-            cell->row, cell->col, cell->gen,
-            (state == ON) ? "on" : "off");
 
+    if (cell->state == state)
         return OK;
-    }
 
     if (cell->state == UNK)
     {
-        DPRINTF("setCell %d %d %d to %s, %s successful\n",
-            cell->row, cell->col, cell->gen,
-            (free ? "free" : "forced"), ((state == ON) ? "on" : "off"));
+        TRACE(TRACE_SET, cell, state, free);
+
+        if (cell->flags & LOOPCELL)
+            return setLoop(cell, state, free);
 
         *newSet++ = cell;
         setState(cell, state);
 
+        if (learnLimit)
+            learnSet(cell);
+
         if (!(free))
-            cell->flags &= ~FREECELL;
+            cell->flags &= ~(FREECELL | CHOSENCELL);
         else
-            cell->flags |= FREECELL;
+            cell->flags = (cell->flags & ~CHOSENCELL) | FREECELL;
+
+        /*
+         * The cell stays in the setting table even if it breaks a limit,
+         * so that backing up tries the other state of a free cell.
+         */
+        if (cell < firstGenEnd)
+            return checkLimits(cell, state);
+
+        return OK;
+    }
+
+    TRACE(TRACE_CONFLICT, cell, state, free);
+
+    return learnError(reasonKind, cell);
+}
+
+/*
+ * Set the state of an unknown cell which belongs to a loop.  The cell
+ * standing for the loop is added to the setting table, and all of the
+ * cells of the loop are set.  This is kept apart from setting the usual
+ * cells outside of loops so that those stay fast.
+ * Returns ERROR if a limit is broken.
+ */
+static Status
+setLoop(Cell * const cell, const State state, const Bool free)
+{
+    Cell * var;
+
+    var = cellVar(cell);
+    *newSet++ = var;
+    setVar(var, state);
+
+    if (!(free))
+        var->flags &= ~(FREECELL | CHOSENCELL);
+    else
+        var->flags = (var->flags & ~CHOSENCELL) | FREECELL;
+
+    if (learnLimit)
+        learnSet(var);
+
+    return checkVar(var, state);
+}
 
+
+/*
+ * Check the limits of generation 0 for a newly set cell and for the
+ * other cells of its loop.
+ * Returns ERROR if a limit is broken.
+ */
+static Status
+checkVar(Cell * const cell, const State state)
+{
+    int off;
+
+    if ((cell < firstGenEnd) && (checkLimits(cell, state) != OK))
+        return ERROR;
+
+    if (cellLoop(cell) < 0)
+        return OK;
+
+    for (off = cellLoop(cell); off != cellOffset(cell); off = loopTable[off])
+    {
+        if ((cellTable + off < firstGenEnd) &&
+            (checkLimits(cellTable + off, state) != OK))
+        {
+            return ERROR;
+        }
+    }
+
+    return OK;
+}
+
+
+/*
+ * Check that a newly set cell of generation 0 keeps within the limits
+ * given by the -mt, -mc, -wc, -nc, -ur and -uc options, and that
+ * generation 0 can still be the least of its images under the symmetries
+ * being broken.  The counts of the row and column already include the
+ * cell.  Cells which are set before the search begins are not checked by
+ * the -mc, -wc and -nc limits.
+ * Returns ERROR if a limit is broken.
+ */
+static Status
+checkLimits(const Cell * const cell, const State state)
+{
+    int row;
+    int col;
+    int nearRow;
+    int nearCol;
+
+    if (!leaderOk())
+        return learnError(REASON_LIMIT, cell);
+
+    if (state == ON)
+    {
+        if (maxCount && (cellCount > maxCount))
+            return learnError(REASON_LIMIT, cell);
+
+        if (!inited || !(colCells || colWidth || nearCols))
+            return OK;
+    }
+    else if (!useRow && !useCol && !(nearCols && inited))
         return OK;
+
+    row = cellRow(cell);
+    col = cellCol(cell);
+
+    if (state == OFF)
+    {
+        if ((row == useRow) && (rowInfo[row].onCount == 0) &&
+            (rowInfo[row].setCount == colMax))
+        {
+            return learnError(REASON_LIMIT, cell);
+        }
+
+        if ((col == useCol) && (colInfo[col].onCount == 0) &&
+            (colInfo[col].setCount == rowMax))
+        {
+            return learnError(REASON_LIMIT, cell);
+        }
+
+        if (!nearCols || !inited)
+            return OK;
+
+        /*
+         * The ON cells in the next columns may have just lost the last
+         * cell which could be near them.
+         */
+        for (nearCol = col + 1;
+            (nearCol <= col + nearCols) && (nearCol <= colMax); nearCol++)
+        {
+            for (nearRow = row - nearCols; nearRow <= row + nearCols;
+                nearRow++)
+            {
+                if ((nearRow < 1) || (nearRow > rowMax) ||
+                    (findCell(nearRow, nearCol, 0)->state != ON))
+                {
+                    continue;
+                }
+
+                if (!hasNear(nearRow, nearCol))
+                    return learnError(REASON_LIMIT, cell);
+            }
+        }
+
+        return OK;
+    }
+
+    if (colCells && (colInfo[col].onCount > colCells))
+        return learnError(REASON_LIMIT, cell);
+
+    if (colWidth && !widthOk(row, col))
+        return learnError(REASON_LIMIT, cell);
+
+    if (nearCols && (col > 1) && !hasNear(row, col))
+        return learnError(REASON_LIMIT, cell);
+
+    return OK;
+}
+
+
+/*
+ * Return whether a number is prime.
+ */
+static Bool
+isPrime(const int num)
+{
+    int div;
+
+    for (div = 2; div * div <= num; div++)
+    {
+        if ((num % div) == 0)
+            return FALSE;
+    }
+
+    return (num > 1);
+}
+
+
+/*
+ * Return whether any cell in generation 0 which is within nearCols rows
+ * of a cell and in the nearCols previous columns could still be ON.
+ */
+static Bool
+hasNear(const int row, const int col)
+{
+    int nearRow;
+    int nearCol;
+
+    for (nearCol = col - nearCols; nearCol < col; nearCol++)
+    {
+        if (nearCol < 1)
+            continue;
+
+        for (nearRow = row - nearCols; nearRow <= row + nearCols; nearRow++)
+        {
+            if ((nearRow >= 1) && (nearRow <= rowMax) &&
+                (findCell(nearRow, nearCol, 0)->state != OFF))
+            {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+
+/*
+ * Return whether an ON cell in generation 0 is within colWidth rows of
+ * all other ON cells of its column.  When rows are mirrored or flipped
+ * at this column, the top and bottom halfs of the column are checked
+ * independently.
+ */
+static Bool
+widthOk(const int row, const int col)
+{
+    int first = 1;
+    int last = rowMax;
+    int nearRow;
+    Cell * cell;
+
+    if ((rowSym && (col >= rowSym)) || (flipRows && (col >= flipRows)))
+    {
+        if (row * 2 <= rowMax + 1)
+            last = (rowMax + 1) / 2;
+        else
+            first = (rowMax + 1) / 2 + 1;
     }
 
-    DPRINTF("setCell %d %d %d to state %s inconsistent\n",
-        cell->row, cell->col, cell->gen,
-        (state == ON) ? "on" : "off");
+    cell = findCell(0, col, 0);
+
+    for (nearRow = first; nearRow <= last; nearRow++)
+    {
+        if ((cell[nearRow].state == ON) &&
+            ((nearRow <= row - colWidth) || (nearRow >= row + colWidth)))
+        {
+            return FALSE;
+        }
+    }
 
-    return ERROR;
+    return TRUE;
 }
 
-void shortSetCell(Cell * const cell, const State state)
+
+Status shortSetCell(Cell * const cell, const State state)
 {
     if (cell->state == UNK)
     {
+        TRACE(TRACE_SET, cell, state, FALSE);
+
+        if (cell->flags & LOOPCELL)
+            return setLoop(cell, state, FALSE);
+
         *newSet++ = cell;
         setState(cell, state);
-        cell->flags &= ~FREECELL;
+        cell->flags &= ~(FREECELL | CHOSENCELL);
+
+        if (learnLimit)
+            learnSet(cell);
+
+        if (cell < firstGenEnd)
+            return checkLimits(cell, state);
     }
 
-    return;
+    return OK;
 }
 
 
@@ -354,15 +671,23 @@ getDesc(const Cell * const cell)
  * Consistify a cell.
  * This means examine this cell in the previous generation, and
  * make sure that the previous generation can validly produce the
- * current cell.  Returns ERROR if the cell is inconsistent.
+ * current cell.  The caller supplies the cell in the previous generation
+ * since it usually knows it already.  Returns ERROR if the cell is
+ * inconsistent.
  */
 static Status
-consistify(Cell * const cell)
+consistify(Cell * const cell, Cell * const prevCell)
 {
-    Cell * prevCell;
     int desc;
     State state;
     Flags flags;
+    Status status = OK;
+
+    /*
+     * Anything set from here on is forced by this cell and the cells
+     * around its past.
+     */
+    reasonCell = cell;
 
     /*
      * First check the transit table entry for the previous
@@ -371,7 +696,6 @@ consistify(Cell * const cell)
      * cell is unknown but the transit table knows the answer,
      * then set the now known state of the cell.
      */
-    prevCell = cell->past;
     desc = SUMTODESC(prevCell->state, prevCell->sumNear);
     state = transit[desc];
 
@@ -394,19 +718,35 @@ consistify(Cell * const cell)
 
     if (cell->state == UNK)
     {
-        if (state != UNK)
+        if (state == UNK)
+            return OK;
+
+        TRACE(TRACE_SET, cell, state, FALSE);
+
+        if (cell->flags & LOOPCELL)
         {
-            *newSet++ = cell;
-            setState(cell, state);
-            cell->flags &= ~FREECELL;
+            if (setLoop(cell, state, FALSE) != OK)
+                return ERROR;
         }
         else
         {
-            return OK;
+            *newSet++ = cell;
+            setState(cell, state);
+            cell->flags &= ~(FREECELL | CHOSENCELL);
+
+            if (learnLimit)
+                learnSet(cell);
+
+            if ((cell < firstGenEnd) && (checkLimits(cell, state) != OK))
+                return ERROR;
         }
     }
     else if ((cell->state ^ state) == ON)
-        return ERROR;
+    {
+        TRACE(TRACE_CONFLICT, cell, state, FALSE);
+
+        return learnError(REASON_SITE, cell);
+    }
 
     /*
      * Now look up the previous generation in the implic table.
@@ -422,8 +762,6 @@ consistify(Cell * const cell)
 
     flags = implic[desc] >> 4 * cell->state;
 
-    DPRINTF("Implication flags %x\n", flags);
-
     if (flags & N0IC0)
         if (setCell(prevCell, OFF, FALSE) != OK)
             return ERROR;
@@ -438,41 +776,51 @@ consistify(Cell * const cell)
          * For each unknown neighbor, set its state as indicated.
          * Return an error if any neighbor is inconsistent.
          */
-        DPRINTF("Forcing unknown neighbors of cell %d %d %d %s\n",
-            prevCell->row, prevCell->col, prevCell->gen, "on");
-
-        shortSetCell(prevCell->cul, ON);
-        shortSetCell(prevCell->cu, ON);
-        shortSetCell(prevCell->cur, ON);
-        shortSetCell(prevCell->cl, ON);
-        shortSetCell(prevCell->cr, ON);
-        shortSetCell(prevCell->cdl, ON);
-        shortSetCell(prevCell->cd, ON);
-        shortSetCell(prevCell->cdr, ON);
-        
-        DPRINTF("Implications successful\n");
-
-        return OK;
+        TRACE(TRACE_FORCE, prevCell, ON, FALSE);
+
+        status = shortSetCell(cellUL(prevCell), ON);
+        status |= shortSetCell(cellU(prevCell), ON);
+        status |= shortSetCell(cellUR(prevCell), ON);
+        status |= shortSetCell(cellL(prevCell), ON);
+        status |= shortSetCell(cellR(prevCell), ON);
+        status |= shortSetCell(cellDL(prevCell), ON);
+        status |= shortSetCell(cellD(prevCell), ON);
+        status |= shortSetCell(cellDR(prevCell), ON);
+
+        return status;
     }
     
     if (flags & N0ICUN0)
     {
-        DPRINTF("Forcing unknown neighbors of cell %d %d %d %s\n",
-            prevCell->row, prevCell->col, prevCell->gen, "off");
-
-        shortSetCell(prevCell->cul, OFF);
-        shortSetCell(prevCell->cu, OFF);
-        shortSetCell(prevCell->cur, OFF);
-        shortSetCell(prevCell->cl, OFF);
-        shortSetCell(prevCell->cr, OFF);
-        shortSetCell(prevCell->cdl, OFF);
-        shortSetCell(prevCell->cd, OFF);
-        shortSetCell(prevCell->cdr, OFF);
+        TRACE(TRACE_FORCE, prevCell, OFF, FALSE);
+
+        status = shortSetCell(cellUL(prevCell), OFF);
+        status |= shortSetCell(cellU(prevCell), OFF);
+        status |= shortSetCell(cellUR(prevCell), OFF);
+        status |= shortSetCell(cellL(prevCell), OFF);
+        status |= shortSetCell(cellR(prevCell), OFF);
+        status |= shortSetCell(cellDL(prevCell), OFF);
+        status |= shortSetCell(cellD(prevCell), OFF);
+        status |= shortSetCell(cellDR(prevCell), OFF);
     }
 
-    DPRINTF("Implications successful\n");
+    return status;
+}
 
-    return OK;
+
+/*
+ * Consistify the future of a cell in the last generation.
+ * The past of that future cell is usually the cell itself, but not
+ * always since the mapping to generation 0 can be flipped.
+ */
+static Status
+consistifyFuture(Cell * const cell)
+{
+    Cell * future;
+
+    future = cellFuture(cell);
+
+    return consistify(future, cellPast(future));
 }
 
 
@@ -483,34 +831,80 @@ consistify(Cell * const cell)
 static Status
 consistify10(Cell * const cell)
 {
-    if (consistify(cell) != OK)
+    Cell * future;
+
+    if (cell >= firstGenEnd)
+    {
+        if (consistify(cell, cell - genStride) != OK)
+            return ERROR;
+    }
+    else if (consistify(cell, cellPast(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->future) != OK)
+    /*
+     * Before the last generation, the neighbors of the cell in the future
+     * are simply the neighbors of the future cell.  For the last generation
+     * they can be translated or flipped, so they have to be looked up.
+     */
+    if (cell < lastGenStart)
+    {
+        future = cell + genStride;
+
+        if (consistify(future, cell) != OK)
+            return ERROR;
+
+        if (consistify(cellUL(future), cellUL(cell)) != OK)
+            return ERROR;
+
+        if (consistify(cellU(future), cellU(cell)) != OK)
+            return ERROR;
+
+        if (consistify(cellUR(future), cellUR(cell)) != OK)
+            return ERROR;
+
+        if (consistify(cellL(future), cellL(cell)) != OK)
+            return ERROR;
+
+        if (consistify(cellR(future), cellR(cell)) != OK)
+            return ERROR;
+
+        if (consistify(cellDL(future), cellDL(cell)) != OK)
+            return ERROR;
+
+        if (consistify(cellD(future), cellD(cell)) != OK)
+            return ERROR;
+
+        if (consistify(cellDR(future), cellDR(cell)) != OK)
+            return ERROR;
+
+        return OK;
+    }
+
+    if (consistifyFuture(cell) != OK)
         return ERROR;
 
-    if (consistify(cell->cul->future) != OK)
+    if (consistifyFuture(cellUL(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->cu->future) != OK)
+    if (consistifyFuture(cellU(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->cur->future) != OK)
+    if (consistifyFuture(cellUR(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->cl->future) != OK)
+    if (consistifyFuture(cellL(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->cr->future) != OK)
+    if (consistifyFuture(cellR(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->cdl->future) != OK)
+    if (consistifyFuture(cellDL(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->cd->future) != OK)
+    if (consistifyFuture(cellD(cell)) != OK)
         return ERROR;
 
-    if (consistify(cell->cdr->future) != OK)
+    if (consistifyFuture(cellDR(cell)) != OK)
         return ERROR;
 
     return OK;
@@ -524,127 +918,617 @@ static Status
 examineNext(void)
 {
     Cell * cell;
+    int off;
+
+    /*
+     * If there are no more cells to examine, then what we have
+     * is consistent.
+     */
+    if (nextSet == newSet)
+        return CONSISTENT;
+
+    /*
+     * Get the next cell to examine, and check it out for symmetry
+     * and for consistency with its previous and next generations.
+     */
+    cell = *nextSet++;
+
+    TRACE(TRACE_EXAMINE, cell, cell->state, (cell->flags & FREECELL) != 0);
+
+    if (learnLimit && (learnPropagate(cell) != OK))
+        return ERROR;
+
+    if (consistify10(cell) != OK)
+        return ERROR;
+
+    /*
+     * The other cells of a loop were set along with the cell, but their
+     * places have to be checked too, unless they are just the places of
+     * the cell under a symmetry of the whole search.
+     */
+    if (!(cell->flags & LOOPCELL) || symLoop(cell))
+        return OK;
+
+    for (off = cellLoop(cell); off != cellOffset(cell); off = loopTable[off])
+    {
+        if (consistify10(cellTable + off) != OK)
+            return ERROR;
+    }
+
+    return OK;
+}
+
+
+/*
+ * Determine all consequences of the cells which have been set but
+ * not yet examined, one cell at a time.
+ */
+static Status
+propagate(void)
+{
+    int status;
+
+    reasonKind = REASON_SITE;
+
+    for (;;)
+    {
+        status = examineNext();
+
+        if (status == ERROR)
+            break;
+
+        if (status == CONSISTENT)
+        {
+            status = OK;
+            break;
+        }
+    }
+
+    reasonKind = REASON_CHOICE;
+
+    return status;
+}
+
+
+/*
+ * Return a value for the cells set since the specified position in
+ * the setting table which does not depend on the order they were set.
+ */
+static unsigned long
+setSum(Cell ** const mark)
+{
+    Cell ** set;
+    unsigned long sum;
+
+    sum = newSet - mark;
+
+    for (set = mark; set < newSet; set++)
+        sum += (cellOffset(*set) * 2UL + (*set)->state + 1) * 2654435761UL;
+
+    return sum;
+}
+
+
+/*
+ * Set a cell to the specified value and determine all consequences we
+ * can from the choice.  Consequences are a contradiction or a consistency.
+ * Unless all objects are wanted, an object with a sub-period is also a
+ * contradiction as soon as generation 0 is complete, so that the search
+ * backs up at once instead of first reporting the object.  This is only
+ * checked once nothing more can be deduced, so that the result does not
+ * depend on the order the engine deduces cells in.
+ */
+Status
+proceed(Cell * cell, State state, Bool free)
+{
+    Status status;
+    Cell ** mark;
+
+    cell = cellVar(cell);
+    mark = newSet;
+    nodeCount++;
+
+    if (setCell(cell, state, free) != OK)
+        return ERROR;
+
+    /*
+     * Remember that the cell was not deduced from the others, since
+     * only such cells are kept in dump files.
+     */
+    cell->flags |= CHOSENCELL;
+
+    if (engine == ENGINE_CELL)
+        status = propagate();
+    else if (engine == ENGINE_BIT)
+        status = bitPropagate();
+    else
+        status = diffPropagate();
+
+    /*
+     * Count the cells set here as a whole, which keeps the counting out
+     * of the engines.
+     */
+    propCount += newSet - mark - 1;
+
+    if (newSet - setTable > maxDepth)
+        maxDepth = newSet - setTable;
+
+    if ((status == OK) && (fullColumns == colMax) && !allObjects &&
+        subPeriods())
+    {
+        return learnError(REASON_LIMIT, cell);
+    }
+
+    return status;
+}
+
+
+/*
+ * Determine the consequences of the cells set since the last propagation
+ * with both engines.  The cell engine is run first, and its settings are
+ * then undone so that the bit engine can start over from the same place.
+ * Both engines must agree on the result.
+ */
+static Status
+diffPropagate(void)
+{
+    Cell * cell;
+    Cell ** mark;
+    Cell ** top;
+    Status status;
+    unsigned long sum;
+
+    mark = nextSet;
+    top = newSet;
+    status = propagate();
+    sum = setSum(mark);
+
+    while (newSet != top)
+    {
+        cell = *--newSet;
+        setVar(cell, UNK);
+        cell->flags |= FREECELL;
+    }
+
+    nextSet = mark;
+
+    if ((bitPropagate() != status) ||
+        ((status == OK) && (setSum(mark) != sum)))
+    {
+        fatal("Cell and bit engines disagree");
+    }
+
+    return status;
+}
+
+
+/*
+ * Back up the list of set cells to undo choices.
+ * Returns the cell which is to be tried for the other possibility.
+ * Returns NULL_CELL on an "object cannot exist" error.
+ */
+Cell *
+backup(void)
+{
+    Cell * cell;
+
+
+    while (newSet != baseSet)
+    {
+        cell = *--newSet;
+
+        TRACE(TRACE_BACKUP, cell, cell->state, (cell->flags & FREECELL) != 0);
+
+        if (!(cell->flags & FREECELL))
+        {
+            setVar(cell, UNK);
+            cell->flags |= FREECELL;
+
+            continue;
+        }
+
+        nextSet = newSet;
+        searchIdx = varIndex(cell);
+
+        return cell;
+    }
+
+    nextSet = baseSet;
+    searchIdx = 0;
+
+    return NULL_CELL;
+}
+
+
+/*
+ * Restart the search from its base.  The states of the cells which were
+ * set are saved to be chosen first again, the order of cells which the
+ * search order leaves tied is shuffled, and the number of conflicts
+ * allowed before the next restart is increased.
+ */
+static void
+restart(void)
+{
+    Cell * cell;
+
+    while (newSet != baseSet)
+    {
+        cell = *--newSet;
+        cell->flags &= ~SAVEDON;
+        cell->flags |= SAVEDCELL | ((cell->state == ON) ? SAVEDON : 0);
+        setVar(cell, UNK);
+        cell->flags |= FREECELL;
+    }
+
+    nextSet = newSet;
+
+    shuffleTies();
+
+    restartCount++;
+
+    if (restartKind == RESTART_LUBY)
+        restartBudget = restartUnit * luby(restartCount + 1);
+    else
+        restartBudget += restartBudget / 2;
+
+    restartAt = stepConfl + restartBudget;
+}
+
+
+/*
+ * Shuffle the runs of cells in the search list which the search order
+ * leaves tied, using the random numbers started from the seed, so that
+ * the searches after restarts differ while staying reproducible.
+ */
+static void
+shuffleTies(void)
+{
+    Cell * cell;
+    int start;
+    int end;
+    int i;
+    int j;
+
+    for (start = 0; start < searchCount; start = end)
+    {
+        end = start + 1;
+
+        while ((end < searchCount) && (orderSortFunc(&searchList[start],
+            &searchList[end], &orderGlobals) == 0))
+        {
+            end++;
+        }
+
+        for (i = end - 1; i > start; i--)
+        {
+            j = start + rand_r(&randState) % (i - start + 1);
+            cell = searchList[i];
+            searchList[i] = searchList[j];
+            searchList[j] = cell;
+        }
+    }
+
+    for (i = 0; i < searchCount; i++)
+        cellIndex(searchList[i]) = i;
+
+    searchIdx = 0;
+
+    if (orderDynamic)
+        dynInit(searchList, searchCount);
+}
+
+
+/*
+ * Return an element of Luby's sequence 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...,
+ * which makes restarts with a good mix of short and long searches.
+ * The elements are numbered from 1.
+ */
+static long
+luby(long i)
+{
+    int k;
+
+    for (;;)
+    {
+        for (k = 1; ((1L << k) - 1) < i; k++)
+            ;
+
+        if (((1L << k) - 1) == i)
+            return 1L << (k - 1);
+
+        i -= (1L << (k - 1)) - 1;
+    }
+}
+
+
+/*
+ * Clear the settings made from the specified position in the setting
+ * table onwards, which starts with a choice, so that the search continues
+ * from there.  This is only done when learning shows that the choices
+ * being cleared had nothing to do with the last conflict.
+ */
+static void
+backjump(Cell ** const mark)
+{
+    Cell * cell;
+
+    if (varIndex(*mark) >= 0)
+        searchIdx = varIndex(*mark);
+
+    while (newSet > mark)
+    {
+        cell = *--newSet;
+
+        if (cell->flags & FREECELL)
+            jumpCount++;
+
+        setVar(cell, UNK);
+        cell->flags |= FREECELL;
+    }
+
+    nextSet = newSet;
+}
+
+
+/*
+ * Do checking based on setting the specified cell.
+ * Returns ERROR if an inconsistency was found.
+ */
+Status
+go(Cell * cell, State state, Bool free)
+{
+    Status status;
+    Cell ** mark;
+    Cell ** top;
+
+    quitOk = FALSE;
+
+    for (;;)
+    {
+        if (free)
+            TRACE(TRACE_DECIDE, cell, state, free);
+
+        top = newSet;
+        status = proceed(cell, state, free);
+
+        if (heatCounting)
+            heatSettings(top, free);
+
+        if (status == OK)
+            return OK;
+
+        ++stepConfl;
+
+        /*
+         * If learning shows that the conflict did not depend on the
+         * latest choices, then clear them and force the cell given by
+         * the learned clause.
+         */
+        if (learnLimit)
+        {
+            mark = learnConflict(&cell, &state);
+
+            if (mark != NULL)
+            {
+                backjump(mark);
+                free = FALSE;
+
+                continue;
+            }
+        }
+
+        cell = backup();
+
+        if (cell == NULL_CELL)
+            return ERROR;
+
+        free = FALSE;
+        state = 1 - cell->state;
+        setVar(cell, UNK);
+    }
+}
+
+
+/*
+ * Look ahead from the cell which is about to be chosen, and from up to
+ * probeLimit - 1 of its unknown neighbors before it, by trying both states
+ * of each of them.  If that changes the settings in any way, then the cell
+ * is returned through the pointer as NULL_CELL, so that the next cell is
+ * found again.  Otherwise the cell is left to be chosen as usual.
+ * Returns ERROR if there are no more possibilities to search.
+ */
+static Status
+probe(Cell ** const cellPtr)
+{
+    Cell * cell = *cellPtr;
+    Cell * near[9];
+    Cell ** top = newSet;
+    long confl = stepConfl;
+    int probed = 0;
+    int i;
+
+    near[0] = cellUL(cell);
+    near[1] = cellU(cell);
+    near[2] = cellUR(cell);
+    near[3] = cellL(cell);
+    near[4] = cellR(cell);
+    near[5] = cellDL(cell);
+    near[6] = cellD(cell);
+    near[7] = cellDR(cell);
+    near[8] = cell;
+
+    for (i = 0; i < 9; i++)
+    {
+        cell = near[i];
+
+        if ((i < 8) && ((probed + 1 >= probeLimit) ||
+            (cell->state != UNK) || !(cell->flags & CHOOSECELL) ||
+            (cellIndex(cell) < 0)))
+        {
+            continue;
+        }
+
+        probed++;
+
+        if (probeCell(cell, (i == 8)) != OK)
+            return ERROR;
+
+        if ((newSet != top) || (stepConfl != confl))
+        {
+            *cellPtr = NULL_CELL;
+
+            break;
+        }
+    }
+
+    return OK;
+}
+
+
+/*
+ * Try both states of an unknown cell, undoing each of them again.
+ * If one of them fails, then the cell is set to the other one, which
+ * is kept from trying it if that was the second one tried.  If both
+ * succeed, then the cells which both of them set the same way are set.
+ * If both fail, then the current choices cannot work, so the cell is set
+ * as a choice again so that the search backs up from it as usual.
+ * If both succeed without any such cells and the cell is the one to be
+ * chosen, then the state which would be chosen first is kept as the
+ * choice instead of being undone.
+ * Returns ERROR if there are no more possibilities to search.
+ */
+static Status
+probeCell(Cell * const cell, const Bool keep)
+{
+    Cell ** mark = newSet;
+    Cell ** next = nextSet;
+    Cell ** set;
+    Cell * fixed;
+    State state = choose(cell);
+    Status firstStatus;
+    Status status;
+    long confl = stepConfl;
+    int count = 0;
+    int i;
+
+    probeCount++;
+    probeStamp += 2;
 
     /*
-     * If there are no more cells to examine, then what we have
-     * is consistent.
+     * Try the state which would not be chosen first, and remember the
+     * states of the cells which it sets.
      */
-    if (nextSet == newSet)
-        return CONSISTENT;
+    firstStatus = proceed(cell, 1 - state, TRUE);
+
+    if (firstStatus == OK)
+    {
+        for (set = mark; set != newSet; set++)
+            probeTable[cellOffset(*set)] = probeStamp + (*set)->state;
+    }
+
+    undoProbe(mark, next);
 
     /*
-     * Get the next cell to examine, and check it out for symmetry
-     * and for consistency with its previous and next generations.
+     * Try the other state, and collect the cells which it sets the same
+     * way.
      */
-    cell = *nextSet++;
+    status = proceed(cell, state, TRUE);
+
+    if ((firstStatus != OK) && (status == OK))
+    {
+        probeFixed++;
+        cellVar(cell)->flags &= ~FREECELL;
 
-    DPRINTF("Examining saved cell %d %d %d (%s) for consistency\n",
-        cell->row, cell->col, cell->gen,
-        ((cell->flags & FREECELL) ? "free" : "forced"));
+        return OK;
+    }
 
-    if (cell->loop && (setCell(cell->loop, cell->state, FALSE) != OK))
+    if ((firstStatus == OK) && (status == OK))
     {
-        return ERROR;
+        for (set = mark + 1; set != newSet; set++)
+        {
+            if (probeTable[cellOffset(*set)] == probeStamp + (*set)->state)
+                probeList[count++] = cellOffset(*set) * 2 + (*set)->state;
+        }
+
+        if (keep && (count == 0))
+            return OK;
     }
 
-    return consistify10(cell);
-}
+    undoProbe(mark, next);
 
+    if ((firstStatus != OK) && (status != OK))
+        return go(cell, state, TRUE);
 
-/*
- * Set a cell to the specified value and determine all consequences we
- * can from the choice.  Consequences are a contradiction or a consistency.
- */
-Status
-proceed(Cell * cell, State state, Bool free)
-{
-    int status;
+    if (status != OK)
+    {
+        probeFixed++;
 
-    if (setCell(cell, state, free) != OK)
-        return ERROR;
+        return go(cell, 1 - state, FALSE);
+    }
 
-    for (;;)
+    /*
+     * Set the cells which are the same either way.  If one of them fails
+     * after all, then go backs up, so the others no longer apply.
+     */
+    for (i = 0; (i < count) && (stepConfl == confl); i++)
     {
-        status = examineNext();
+        fixed = cellTable + probeList[i] / 2;
 
-        if (status == ERROR)
-            return ERROR;
+        if (fixed->state != UNK)
+            continue;
 
-        if (status == CONSISTENT)
-            return OK;
+        probeFixed++;
+
+        if (go(fixed, probeList[i] % 2, FALSE) != OK)
+            return ERROR;
     }
+
+    return OK;
 }
 
 
 /*
- * Back up the list of set cells to undo choices.
- * Returns the cell which is to be tried for the other possibility.
- * Returns NULL_CELL on an "object cannot exist" error.
+ * Undo the settings made by trying a state of a cell.
  */
-Cell *
-backup(void)
+static void
+undoProbe(Cell ** const mark, Cell ** const next)
 {
     Cell * cell;
 
-
-    while (newSet != baseSet)
+    while (newSet != mark)
     {
         cell = *--newSet;
-
-        DPRINTF("backing up cell %d %d %d, was %s, %s\n",
-            cell->row, cell->col, cell->gen,
-            ((cell->state == ON) ? "on" : "off"),
-            ((cell->flags & FREECELL) ? "free": "forced"));
-
-        if (!(cell->flags & FREECELL))
-        {
-            setState(cell, UNK);
-            cell->flags |= FREECELL;
-
-            continue;
-        }
-
-        nextSet = newSet;
-        searchIdx = cell->index;
-
-        return cell;
+        setVar(cell, UNK);
+        cell->flags |= FREECELL;
     }
 
-    nextSet = baseSet;
-    searchIdx = 0;
-
-    return NULL_CELL;
+    nextSet = next;
 }
 
 
 /*
- * Do checking based on setting the specified cell.
- * Returns ERROR if an inconsistency was found.
+ * Return the first place in the search list of a cell or of any other
+ * cell of its loop, since the cell standing for a loop need not be in
+ * the search list itself.  Returns -1 if none of them are.
  */
-Status
-go(Cell * cell, State state, Bool free)
+static int
+varIndex(const Cell * const cell)
 {
-    Status status;
-
-    quitOk = FALSE;
-
-    for (;;)
-    {
-        status = proceed(cell, state, free);
-
-        if (status == OK)
-            return OK;
+    int index;
+    int off;
 
-        ++stepConfl;
-        cell = backup();
+    index = cellIndex(cell);
 
-        if (cell == NULL_CELL)
-            return ERROR;
+    if (!(cell->flags & LOOPCELL))
+        return index;
 
-        free = FALSE;
-        state = 1 - cell->state;
-        setState(cell, UNK);
+    for (off = cellLoop(cell); off != cellOffset(cell); off = loopTable[off])
+    {
+        if ((indexTable[off] >= 0) && ((index < 0) || (indexTable[off] < index)))
+            index = indexTable[off];
     }
+
+    return index;
 }
 
 
@@ -657,6 +1541,9 @@ getNormalUnknown(void)
 {
     Cell * cell;
 
+    if (orderDynamic)
+        return dynFirst();
+
     for (int i = searchIdx; i < searchCount; i++)
     {
         cell = searchList[i];
@@ -676,6 +1563,28 @@ getNormalUnknown(void)
 }
 
 
+/*
+ * Return the next cell which the search would choose from the current
+ * settings, and the state it would try first, without setting it.
+ * The search position starts again from the beginning, since settings
+ * may have been cleared.
+ * Returns NULL_CELL if there are no more unknown cells.
+ */
+Cell *
+nextChoice(State * statePtr)
+{
+    Cell * cell;
+
+    searchIdx = 0;
+    cell = getNormalUnknown();
+
+    if (cell != NULL_CELL)
+        *statePtr = choose(cell);
+
+    return cell;
+}
+
+
 /*
  * Choose a state for an unknown cell, either OFF or ON.
  * Normally, we try to choose OFF cells first to terminate an object.
@@ -685,20 +1594,27 @@ getNormalUnknown(void)
 static State
 choose(const Cell * cell)
 {
+    /*
+     * If the cell had a state when the search was last restarted,
+     * then try that state again so that the progress is not lost.
+     */
+    if (cellVar(cell)->flags & SAVEDCELL)
+        return (cellVar(cell)->flags & SAVEDON) ? ON : OFF;
+
     /*
      * If we are following cells in other generations,
      * then try to do that.
      */
     if (followGens)
     {
-        if ((cell->past->state == ON) ||
-            (cell->future->state == ON))
+        if ((cellPast(cell)->state == ON) ||
+            (cellFuture(cell)->state == ON))
         {
             return ON;
         }
 
-        if ((cell->past->state == OFF) ||
-            (cell->future->state == OFF))
+        if ((cellPast(cell)->state == OFF) ||
+            (cellFuture(cell)->state == OFF))
         {
             return OFF;
         }
@@ -731,7 +1647,7 @@ search(const Bool batch)
 
         free = FALSE;
         state = 1 - cell->state;
-        setState(cell, UNK);
+        setVar(cell, UNK);
     }
     else
     {
@@ -742,9 +1658,10 @@ search(const Bool batch)
     for (;;)
     {
         /*
-         * Set the state of the new cell.
+         * Set the state of the new cell, unless probing already changed
+         * the settings.
          */
-        if (go(cell, state, free) != OK)
+        if ((cell != NULL_CELL) && (go(cell, state, free) != OK))
             return NOT_EXIST;
 
         /*
@@ -752,7 +1669,11 @@ search(const Bool batch)
          */
         if (dumpFlag)
         {
-            dumpState(dumpFile);
+            if (forkDumps)
+                snapshotState(dumpFile);
+            else
+                dumpState(dumpFile);
+
             dumpFlag = FALSE;
         }
 
@@ -765,6 +1686,59 @@ search(const Bool batch)
             viewFlag = FALSE;
         }
 
+        /*
+         * If it is time to record the statistics, then append them.
+         */
+        if (statsFlag)
+        {
+            if (statsFile)
+                writeStats();
+
+            statsFlag = FALSE;
+        }
+
+        /*
+         * If the heatmap was asked for, then write it.
+         */
+        if (heatFlag)
+        {
+            if (heatFile)
+                writeHeat(heatFile);
+
+            heatFlag = FALSE;
+        }
+
+        /*
+         * If the trace was asked for, then write it.
+         */
+        if (traceFlag)
+        {
+            if (traceFile)
+                writeTrace(traceFile);
+
+            traceFlag = FALSE;
+        }
+
+        /*
+         * If other workers have run out of work, then give away
+         * the shallowest branch which has not yet been tried.
+         */
+        if (stealFlag && *stealFlag)
+            donateWork();
+
+        /*
+         * If the search has been cancelled, then stop it.
+         */
+        if (cancelFlag)
+            return ERROR;
+
+        /*
+         * If restarting and the conflicts allowed since the last
+         * restart have been used up, then start again from the base.
+         */
+        if (restartKind && (stepConfl >= restartAt))
+            restart();
+
         /*
          * Check for commands.
          */
@@ -776,22 +1750,53 @@ search(const Bool batch)
 
         /*
          * Get the next unknown cell and choose its state.
+         * If probing, then look ahead from it first, which can set
+         * cells, in which case the next cell is found again.
          */
         cell = getNormalUnknown();
 
         if (cell == NULL_CELL)
             return FOUND;
 
+        if (probeLimit)
+        {
+            if (probe(&cell) != OK)
+                return NOT_EXIST;
+
+            if (cell == NULL_CELL)
+                continue;
+        }
+
         state = choose(cell);
         free = TRUE;
     }
 }
 
 
+/*
+ * Check whether an object which was just found should be reported.
+ * Objects with sub-periods are skipped unless all objects are wanted, and
+ * objects already found are skipped if duplicates are being suppressed.
+ * This is used by every way of running a search, so that they all report
+ * the same objects.
+ */
+Bool
+acceptObject(void)
+{
+    if (!allObjects && subPeriods())
+        return FALSE;
+
+    return uniqueObject();
+}
+
+
 /*
  * Check to see if any other generation is identical to generation 0.
  * This is used to detect and weed out all objects with subPeriods.
  * (For example, stable objects or period 2 objects when using -g4.)
+ * Only the generations which are the period divided by a prime need to
+ * be compared.  Generation 0 is fully known whenever this is called, so
+ * unknown cells in the other generations are never the same.
  * Returns TRUE if there is an identical generation.
  */
 Bool
@@ -800,13 +1805,13 @@ subPeriods(void)
     int row;
     int col;
     int gen;
+    int i;
     const Cell * cellG0;
     const Cell * cellGn;
 
-    for (gen = 1; gen < genMax; gen++)
+    for (i = 0; i < periodCount; i++)
     {
-        if (genMax % gen)
-            continue;
+        gen = periodGens[i];
 
         for (row = 1; row <= rowMax; row++)
         {
@@ -832,39 +1837,42 @@ nextGen:;
  * Return the mapping of a cell from the last generation back to the first
  * generation, or vice versa.  This implements all flipping and translating
  * of cells between these two generations.  This routine should only be
- * called for cells belonging to those two generations.
+ * called for cells belonging to those two generations.  The mapping back
+ * from the first generation undoes the steps of the forward mapping in
+ * the reverse order, so that the past and future of a cell always agree.
  */
-static Cell *
+Cell *
 mapCell(const Cell * cell, Bool forward)
 {
     int row;
     int col;
     int tmp;
 
-    row = cell->row;
-    col = cell->col;
+    row = cellRow(cell);
+    col = cellCol(cell);
 
-    if (flipRows && (col >= flipRows))
-        row = rowMax + 1 - row;
+    if (forward)
+    {
+        if (flipRows && (col >= flipRows))
+            row = rowMax + 1 - row;
 
-    if (flipCols && (row >= flipCols))
-        col = colMax + 1 - col;
+        if (flipCols && (row >= flipCols))
+            col = colMax + 1 - col;
 
-    if (flipQuads)
-    {                /* NEED TO GO BACKWARDS */
-        tmp = col;
-        col = row;
-        row = colMax + 1 - tmp;
-    }
+        if (flipQuads)
+        {
+            tmp = col;
+            col = row;
+            row = colMax + 1 - tmp;
+        }
 
-    if (forward)
-    {
         if (flipFwd)
         {       /* For Glide Symmetry */
             tmp = col;
-            col = rowMax + 1 - col;
+            col = rowMax + 1 - row;
             row = colMax + 1 - tmp;
         }
+
         if (flipBwd)
         {
             tmp = col;
@@ -880,18 +1888,32 @@ mapCell(const Cell * cell, Bool forward)
         row -= rowTrans;
         col -= colTrans;
 
+        if (flipBwd)
+        {
+            tmp = col;
+            col = row;
+            row = tmp;
+        }
+
         if (flipFwd)
         {       /* For Glide Symmetry */
             tmp = col;
-            col = rowMax + 1 - col;
+            col = rowMax + 1 - row;
             row = colMax + 1 - tmp;
         }
-        if (flipBwd)
+
+        if (flipQuads)
         {
-            tmp = col;
-            col = row;
-            row = tmp;
+            tmp = row;
+            row = col;
+            col = colMax + 1 - tmp;
         }
+
+        if (flipCols && (row >= flipCols))
+            col = colMax + 1 - col;
+
+        if (flipRows && (col >= flipRows))
+            row = rowMax + 1 - row;
     }
 
     if (forward)
@@ -907,41 +1929,50 @@ mapCell(const Cell * cell, Bool forward)
  * This will force the state of these two cells to follow each other.
  * Symmetry uses this feature, and so does setting stable cells.
  * If any cells in the loop are frozen, then they all are.
+ * The cells of a loop are one variable of the search, which is set and
+ * kept in the setting table as the cell of the loop with the lowest
+ * offset, like the root of a union of sets.
  */
 void
 loopCells(Cell * cell1, Cell * cell2)
 {
-    Cell * cell;
+    int off1;
+    int off2;
+    int off;
+    int var;
     Bool frozen;
 
     /*
      * Check simple cases of equality, or of either cell
-     * being the deadCell.
+     * not existing.
      */
-    if ((cell1 == deadCell) || (cell2 == deadCell))
-        fatal("Attemping to use deadCell in a loop");
-
-    if (cell1 == cell2)
+    if ((cell1 == NULL_CELL) || (cell2 == NULL_CELL) || (cell1 == cell2))
         return;
 
+    off1 = cellOffset(cell1);
+    off2 = cellOffset(cell2);
+
     /*
      * Make the cells belong to their own loop if required.
      * This will simplify the code.
      */
-    if (cell1->loop == NULL)
-        cell1->loop = cell1;
+    if (loopTable[off1] < 0)
+        loopTable[off1] = off1;
+
+    if (loopTable[off2] < 0)
+        loopTable[off2] = off2;
 
-    if (cell2->loop == NULL)
-        cell2->loop = cell2;
+    cell1->flags |= LOOPCELL;
+    cell2->flags |= LOOPCELL;
 
     /*
      * See if the second cell is already part of the first cell's loop.
      * If so, they they are already joined.  We don't need to
      * check the other direction.
      */
-    for (cell = cell1->loop; cell != cell1; cell = cell->loop)
+    for (off = loopTable[off1]; off != off1; off = loopTable[off])
     {
-        if (cell == cell2)
+        if (off == off2)
             return;
     }
 
@@ -949,9 +1980,23 @@ loopCells(Cell * cell1, Cell * cell2)
      * The two cells belong to separate loops.
      * Break each of those loops and make one big loop from them.
      */
-    cell = cell1->loop;
-    cell1->loop = cell2->loop;
-    cell2->loop = cell;
+    off = loopTable[off1];
+    loopTable[off1] = loopTable[off2];
+    loopTable[off2] = off;
+
+    /*
+     * The joined loop is stood for by the lower of the cells standing
+     * for the two loops.
+     */
+    var = varTable[off1];
+
+    if (varTable[off2] < var)
+        var = varTable[off2];
+
+    varTable[off1] = var;
+
+    for (off = loopTable[off1]; off != off1; off = loopTable[off])
+        varTable[off] = var;
 
     /*
      * See if any of the cells in the loop are frozen.
@@ -961,9 +2006,9 @@ loopCells(Cell * cell1, Cell * cell2)
      */
     frozen = cell1->flags & FROZENCELL;
 
-    for (cell = cell1->loop; cell != cell1; cell = cell->loop)
+    for (off = loopTable[off1]; off != off1; off = loopTable[off])
     {
-        if (cell->flags & FROZENCELL)
+        if (cellTable[off].flags & FROZENCELL)
             frozen = TRUE;
     }
 
@@ -971,8 +2016,8 @@ loopCells(Cell * cell1, Cell * cell2)
     {
         cell1->flags |= FROZENCELL;
 
-        for (cell = cell1->loop; cell != cell1; cell = cell->loop)
-            cell->flags |= FROZENCELL;
+        for (off = loopTable[off1]; off != off1; off = loopTable[off])
+            cellTable[off].flags |= FROZENCELL;
     }
 }
 
@@ -995,8 +2040,8 @@ symCell(const Cell * cell)
     if (!rowSym && !colSym && !pointSym && !fwdSym && !bwdSym)
         return NULL_CELL;
 
-    row = cell->row;
-    col = cell->col;
+    row = cellRow(cell);
+    col = cellCol(cell);
     nRow = rowMax + 1 - row;
     nCol = colMax + 1 - col;
 
@@ -1004,19 +2049,19 @@ symCell(const Cell * cell)
      * If this is point symmetry, then this is easy.
      */
     if (pointSym)
-        return findCell(nRow, nCol, cell->gen);
+        return findCell(nRow, nCol, cellGen(cell));
 
     /*
      * If this is forward diagonal symmetry, then this is easy.
      */
     if (fwdSym)
-        return findCell(nCol, nRow, cell->gen);
+        return findCell(nCol, nRow, cellGen(cell));
 
     /*
      * If this is backward diagonal symmetry, then this is easy.
      */
     if (bwdSym)
-        return findCell(col, row, cell->gen);
+        return findCell(col, row, cellGen(cell));
 
     /*
      * If there is symmetry on only one axis, then this is easy.
@@ -1026,7 +2071,7 @@ symCell(const Cell * cell)
         if (col < rowSym)
             return NULL_CELL;
 
-        return findCell(nRow, col, cell->gen);
+        return findCell(nRow, col, cellGen(cell));
     }
 
     if (!rowSym)
@@ -1034,7 +2079,7 @@ symCell(const Cell * cell)
         if (row < colSym)
             return NULL_CELL;
 
-        return findCell(row, nCol, cell->gen);
+        return findCell(row, nCol, cellGen(cell));
     }
 
     /*
@@ -1043,7 +2088,7 @@ symCell(const Cell * cell)
      * and if so, then this is easy.
      */
     if ((nRow == row) || (nCol == col))
-        return findCell(nRow, nCol, cell->gen);
+        return findCell(nRow, nCol, cellGen(cell));
 
     /*
      * The cell is really in one of the four quadrants, and therefore
@@ -1051,170 +2096,231 @@ symCell(const Cell * cell)
      * symmetrical cell in the next quadrant clockwise.
      */
     if ((row < nRow) == (col < nCol))
-        return findCell(row, nCol, cell->gen);
+        return findCell(row, nCol, cellGen(cell));
     else
-        return findCell(nRow, col, cell->gen);
+        return findCell(nRow, col, cellGen(cell));
 }
 
-
 /*
- * Link a cell to its eight neighbors in the same generation, and also
- * link those neighbors back to this cell.
+ * Return whether the symmetry of the search applies to all of the cells
+ * in every generation, and maps the cells of the last generation onto
+ * the cells of the first generation the same way as their images.  If so,
+ * then checking the place of one cell of a loop checks the places of the
+ * other cells of the loop too.
  */
-static void
-linkCell(Cell * cell)
+static Bool
+wholeSymmetry(void)
 {
     int row;
     int col;
-    int gen;
-    Cell * pairCell;
+    Cell * cell;
+    Cell * image;
+
+    if (!rowSym && !colSym && !pointSym && !fwdSym && !bwdSym)
+        return FALSE;
+
+    if ((rowSym > 1) || (colSym > 1))
+        return FALSE;
+
+    for (row = 1; row <= rowMax; row++)
+        for (col = 1; col <= colMax; col++)
+    {
+        cell = findCell(row, col, genMax - 1);
+        image = symCell(cell);
 
-    row = cell->row;
-    col = cell->col;
-    gen = cell->gen;
+        if (image && !sameVar(mapCell(cell, TRUE), mapCell(image, TRUE)))
+            return FALSE;
 
-    pairCell = findCell(row - 1, col - 1, gen);
-    cell->cul = pairCell;
-    pairCell->cdr = cell;
+        cell = findCell(row, col, 0);
+        image = symCell(cell);
+
+        if (image && !sameVar(mapCell(cell, FALSE), mapCell(image, FALSE)))
+            return FALSE;
+    }
 
-    pairCell = findCell(row - 1, col, gen);
-    cell->cu = pairCell;
-    pairCell->cd = cell;
+    return TRUE;
+}
 
-    pairCell = findCell(row - 1, col + 1, gen);
-    cell->cur = pairCell;
-    pairCell->cdl = cell;
 
-    pairCell = findCell(row, col - 1, gen);
-    cell->cl = pairCell;
-    pairCell->cr = cell;
+/*
+ * Return whether two cells always have the same state, either because
+ * they belong to the same loop or because they are both outside of the
+ * search area.
+ */
+static Bool
+sameVar(const Cell * const cell1, const Cell * const cell2)
+{
+    Bool outside1;
+    Bool outside2;
 
-    pairCell = findCell(row, col + 1, gen);
-    cell->cr = pairCell;
-    pairCell->cl = cell;
+    outside1 = ((cellRow(cell1) < 1) || (cellRow(cell1) > rowMax) ||
+        (cellCol(cell1) < 1) || (cellCol(cell1) > colMax));
 
-    pairCell = findCell(row + 1, col - 1, gen);
-    cell->cdl = pairCell;
-    pairCell->cur = cell;
+    outside2 = ((cellRow(cell2) < 1) || (cellRow(cell2) > rowMax) ||
+        (cellCol(cell2) < 1) || (cellCol(cell2) > colMax));
 
-    pairCell = findCell(row + 1, col, gen);
-    cell->cd = pairCell;
-    pairCell->cu = cell;
+    if (outside1 || outside2)
+        return (outside1 && outside2);
 
-    pairCell = findCell(row + 1, col + 1, gen);
-    cell->cdr = pairCell;
-    pairCell->cul = cell;
+    return (cellVar(cell1) == cellVar(cell2));
 }
 
 
 /*
- * Find a cell given its coordinates.
- * Most coordinates range from 0 to colMax+1, 0 to rowMax+1, and 0 to genMax-1.
- * Cells within this range are quickly found by indexing into cellTable.
- * Cells outside of this range are handled by searching an auxillary table,
- * and are dynamically created as necessary.
+ * Return whether the other cells of the loop of a cell are only its images
+ * under the symmetry of the whole search.  This is not so once cells are
+ * frozen, since then the loop also joins the generations of the cell.
  */
-Cell *
-findCell(int row, int col, int gen)
+static Bool
+symLoop(const Cell * const cell)
 {
-    Cell * cell;
-    int i;
+    int off;
 
-    /*
-     * If the cell is a normal cell, then we know where it is.
-     */
-    if ((row >= 0) && (row <= rowMax + 1) &&
-        (col >= 0) && (col <= colMax + 1) &&
-        (gen >= 0) && (gen < genMax))
-    {
-        return cellTable[(col * (rowMax + 2) + row) * genMax + gen];
-    }
+    if (!symWhole)
+        return FALSE;
 
-    /*
-     * See if the cell is already allocated in the auxillary table.
-     */
-    for (i = 0; i < auxCellCount; i++)
+    for (off = cellLoop(cell); off != cellOffset(cell); off = loopTable[off])
     {
-        cell = auxTable[i];
-
-        if ((cell->row == row) && (cell->col == col) &&
-            (cell->gen == gen))
-        {
-            return cell;
-        }
+        if (off / genStride != cellGen(cell))
+            return FALSE;
     }
 
-    /*
-     * Need to allocate the cell and add it to the auxillary table.
-     */
-    if (auxCellCount >= AUX_CELLS)
-        fatal("Too many auxillary cells");
+    return TRUE;
+}
 
-    cell = allocateCell();
-    cell->row = row;
-    cell->col = col;
-    cell->gen = gen;
-    auxTable[auxCellCount++] = cell;
 
-    return cell;
+/*
+ * Find a cell given its coordinates.
+ * Most coordinates range from 0 to colMax+1, 0 to rowMax+1, and 0 to genMax-1.
+ * The cells up to CELL_PAD beyond that range are always OFF, and are used
+ * for translations and as the neighbors of the boundary cells.
+ */
+Cell *
+findCell(int row, int col, int gen)
+{
+    if ((row < -CELL_PAD) || (row > rowMax + 1 + CELL_PAD) ||
+        (col < -CELL_PAD) || (col > colMax + 1 + CELL_PAD) ||
+        (gen < 0) || (gen >= genMax))
+    {
+        fatal("Cell out of range");
+    }
+
+    return cellTable + gen * genStride + (col + CELL_PAD) * colStride +
+        row + CELL_PAD;
 }
 
 
 /*
- * Allocate a new cell.
- * The cell is initialized as if it was a boundary cell.
- * Warning: The first allocation MUST be of the deadCell.
+ * Allocate the table of cells and its parallel tables, along with the
+ * other tables whose sizes depend on the size of the search, freeing
+ * the tables of any previous search.
+ * All cells are initialized as if they were boundary cells,
+ * with the past and future cells wrapping around at the ends.
  */
-static Cell *
-allocateCell(void)
+static void
+allocateCells(void)
 {
     Cell * cell;
-
-    /*
-     * Allocate a new chunk of cells if there are none left.
-     */
-    if (newCellCount <= 0)
+    int off;
+
+    colStride = rowMax + 2 + CELL_PAD * 2;
+    genStride = colStride * (colMax + 2 + CELL_PAD * 2);
+    cellCountAll = genStride * genMax;
+
+    free(cellTable);
+    free(pastTable);
+    free(futureTable);
+    free(loopTable);
+    free(varTable);
+    free(indexTable);
+    free(probeTable);
+    free(probeList);
+    free(periodGens);
+    free(setTable);
+    free(rowInfo);
+    free(colInfo);
+
+    cellTable = (Cell *) malloc(sizeof(Cell) * cellCountAll);
+    pastTable = (int *) malloc(sizeof(int) * cellCountAll);
+    futureTable = (int *) malloc(sizeof(int) * cellCountAll);
+    loopTable = (int *) malloc(sizeof(int) * cellCountAll);
+    varTable = (int *) malloc(sizeof(int) * cellCountAll);
+    indexTable = (int *) malloc(sizeof(int) * cellCountAll);
+    probeTable = (unsigned int *) calloc(cellCountAll, sizeof(unsigned int));
+    probeList = (int *) malloc(sizeof(int) * cellCountAll);
+    periodGens = (int *) malloc(sizeof(int) * genMax);
+    setTable = (Cell **) malloc(sizeof(Cell *) * cellCountAll);
+    rowInfo = (RowInfo *) calloc(rowMax + 2, sizeof(RowInfo));
+    colInfo = (ColInfo *) calloc(colMax + 2, sizeof(ColInfo));
+
+    if ((cellTable == NULL) || (pastTable == NULL) ||
+        (futureTable == NULL) || (loopTable == NULL) ||
+        (varTable == NULL) || (indexTable == NULL) ||
+        (probeTable == NULL) || (probeList == NULL) ||
+        (periodGens == NULL) || (setTable == NULL) ||
+        (rowInfo == NULL) || (colInfo == NULL))
     {
-        newCells = (Cell *) malloc(sizeof(Cell) * ALLOC_SIZE);
-
-        if (newCells == NULL)
-            fatal("Cannot allocate cell structure");
-
-        newCellCount = ALLOC_SIZE;
+        fatal("Cannot allocate cell table");
     }
 
-    newCellCount--;
-    cell = newCells++;
+    firstGenEnd = cellTable + genStride;
+    lastGenStart = cellTable + genStride * (genMax - 1);
 
-    /*
-     * If this is the first allocation, then make deadCell be this cell.
-     */
-    if (deadCell == NULL)
-        deadCell = cell;
+    for (off = 0; off < cellCountAll; off++)
+    {
+        cell = &cellTable[off];
+        cell->state = OFF;
+        cell->flags = CHOOSECELL;
+        cell->sumNear = 0;
+        pastTable[off] = (off + cellCountAll - genStride) % cellCountAll;
+        futureTable[off] = (off + genStride) % cellCountAll;
+        loopTable[off] = -1;
+        varTable[off] = off;
+        indexTable[off] = -1;
+    }
+}
 
-    /*
-     * Fill in the cell as if it was a boundary cell.
-     */
-    cell->state = OFF;
-    cell->flags = CHOOSECELL;
-    cell->gen = -1;
-    cell->row = -1;
-    cell->col = -1;
-    cell->sumNear = 0;
-    cell->index = -1;
-    cell->past = deadCell;
-    cell->future = deadCell;
-    cell->cul = deadCell;
-    cell->cu = deadCell;
-    cell->cur = deadCell;
-    cell->cl = deadCell;
-    cell->cr = deadCell;
-    cell->cdl = deadCell;
-    cell->cd = deadCell;
-    cell->cdr = deadCell;
-    cell->loop = NULL;
 
-    return cell;
+/*
+ * Free all of the tables of the search, so that the thread which ran
+ * it can go away without leaking them.
+ */
+void
+freeCells(void)
+{
+    free(cellTable);
+    free(pastTable);
+    free(futureTable);
+    free(loopTable);
+    free(varTable);
+    free(indexTable);
+    free(probeTable);
+    free(probeList);
+    free(periodGens);
+    free(setTable);
+    free(rowInfo);
+    free(colInfo);
+    free(searchList);
+
+    cellTable = NULL;
+    pastTable = NULL;
+    futureTable = NULL;
+    loopTable = NULL;
+    varTable = NULL;
+    indexTable = NULL;
+    probeTable = NULL;
+    probeList = NULL;
+    periodGens = NULL;
+    setTable = NULL;
+    rowInfo = NULL;
+    colInfo = NULL;
+    searchList = NULL;
+
+    bitFree();
+    learnFree();
+    dynFree();
+    leaderFree();
+    heatFree();
 }
 
 /* END CODE */
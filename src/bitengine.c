@@ -0,0 +1,731 @@
+#include <stdint.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "flags.h"
+#include "transition.h"
+#include "implication.h"
+#include "bitengine.h"
+#include "heatmap.h"
+#include "trace.h"
+
+/*
+ * Bit-parallel propagation engine.
+ * Each column of each generation is kept as two bit masks, one for the
+ * cells which are ON and one for the cells which are unknown, with one bit
+ * per row of the padded plane.  Columns are used rather than rows since
+ * the rows of a column are adjacent in the cell table, so that a unit is
+ * simply a range of cells, and a whole column fits in one word.
+ * Evaluating a unit checks the cells of that column against their futures
+ * for all of the triggered rows at once.  The neighbor counts are found
+ * by adding the shifted columns together as bit slices, and the rules of
+ * the transit and implic tables are then applied to whole words.
+ *
+ * Setting a cell triggers the same cells which the cell engine would
+ * consistify, namely its neighborhood and its past, and units with
+ * triggered cells are evaluated in turn until no more cells are set.
+ */
+typedef	uint64_t	Bits;
+
+#define	WORD_BITS	64
+
+/*
+ * Outcomes of the rules for one combination of the state of a cell and
+ * its neighbor counts.  The implications depend on the state of the
+ * future cell, and so are kept for both states.
+ */
+#define	RULE_ON		0x001	/* future cell becomes ON */
+#define	RULE_OFF	0x002	/* future cell becomes OFF */
+#define	RULE_SHIFT_OFF	2	/* shift of implications for future OFF */
+#define	RULE_SHIFT_ON	6	/* shift of implications for future ON */
+
+typedef	unsigned short	Rule;
+
+static SEARCH_LOCAL Rule	rules[nStates][9][9];	/* indexed by state, on and unknown counts */
+static SEARCH_LOCAL int	planeCols;	/* number of columns in a padded plane */
+static SEARCH_LOCAL int	unitCount;	/* number of units */
+static SEARCH_LOCAL int	wrapUnits;	/* first unit of the last generation */
+static SEARCH_LOCAL Bits *	onBits;		/* cells which are ON */
+static SEARCH_LOCAL Bits *	unkBits;	/* cells which are unknown */
+static SEARCH_LOCAL Bits *	pending;	/* cells triggered in each unit */
+static SEARCH_LOCAL int *	queue;		/* units waiting to be evaluated */
+static SEARCH_LOCAL int	queueHead;	/* first unit in the queue */
+static SEARCH_LOCAL int	queueCount;	/* number of units in the queue */
+
+static void markCell(const Cell * const);
+static void markBits(const int, const Bits);
+static void markFuture(const int);
+static void clearPending(void);
+static Status evalUnit(const int);
+static Status evalWrap(const int);
+static void countNeighbors(Bits *, const Bits, const Bits, const Bits);
+static Bits countIs(const Bits *, const int);
+static void conflictBits(const Cell * const, Bits);
+static int sliceValue(const Bits *, const int);
+static Status setBits(Cell * const, Bits, const State);
+
+
+/*
+ * Build the bit masks from the current states of the cells.
+ * This is called after the cells have been initialized, and from then
+ * on the masks are kept up to date as the cells change state.
+ */
+void
+bitInit(void)
+{
+	const Cell *	cell;
+	State		state;
+	Flags		flags;
+	Rule		rule;
+	int		stateIndex;
+	int		onCount;
+	int		unkCount;
+	int		off;
+	static const State	states[nStates] = {OFF, ON, UNK};
+
+	if (colStride > WORD_BITS)
+		fatal("Too many rows for the bit engine");
+
+	planeCols = genStride / colStride;
+	unitCount = genMax * planeCols;
+	wrapUnits = (genMax - 1) * planeCols;
+
+	free(onBits);
+	free(unkBits);
+	free(pending);
+	free(queue);
+
+	onBits = (Bits *) calloc(unitCount, sizeof(Bits));
+	unkBits = (Bits *) calloc(unitCount, sizeof(Bits));
+	pending = (Bits *) calloc(unitCount, sizeof(Bits));
+	queue = (int *) malloc(unitCount * sizeof(int));
+
+	if ((onBits == NULL) || (unkBits == NULL) || (pending == NULL) ||
+		(queue == NULL))
+	{
+		fatal("Cannot allocate bit tables");
+	}
+
+	queueHead = 0;
+	queueCount = 0;
+
+	for (off = 0; off < genStride * genMax; off++)
+	{
+		cell = &cellTable[off];
+
+		if (cell->state == ON)
+			onBits[off / colStride] |= ((Bits) 1) << (off % colStride);
+
+		if (cell->state == UNK)
+			unkBits[off / colStride] |= ((Bits) 1) << (off % colStride);
+	}
+
+	/*
+	 * Collect the outcomes of the transition and implication rules
+	 * for every combination of cell state and neighbor counts.
+	 */
+	for (stateIndex = 0; stateIndex < nStates; stateIndex++)
+	{
+		state = states[stateIndex];
+
+		for (onCount = 0; onCount <= 8; onCount++)
+		{
+			for (unkCount = 0; onCount + unkCount <= 8; unkCount++)
+			{
+				rule = 0;
+
+				switch (transition(state, 8 - onCount - unkCount,
+					onCount))
+				{
+					case ON:
+						rule |= RULE_ON;
+						break;
+
+					case OFF:
+						rule |= RULE_OFF;
+						break;
+				}
+
+				flags = implication(state, 8 - onCount - unkCount,
+					onCount);
+
+				rule |= (flags & 0x0f) << RULE_SHIFT_OFF;
+				rule |= ((flags >> 4) & 0x0f) << RULE_SHIFT_ON;
+
+				rules[stateIndex][onCount][unkCount] = rule;
+			}
+		}
+	}
+}
+
+
+/*
+ * Free the bit masks.
+ */
+void
+bitFree(void)
+{
+	free(onBits);
+	free(unkBits);
+	free(pending);
+	free(queue);
+
+	onBits = NULL;
+	unkBits = NULL;
+	pending = NULL;
+	queue = NULL;
+}
+
+
+/*
+ * Update the bit masks for a cell which is changing state.
+ * This is called from setState, and does nothing until the masks exist.
+ */
+void
+bitUpdate(const Cell * const cell, const State state)
+{
+	int	off;
+	Bits	mask;
+
+	if (onBits == NULL)
+		return;
+
+	off = cellOffset(cell);
+	mask = ((Bits) 1) << (off % colStride);
+	off /= colStride;
+
+	onBits[off] &= ~mask;
+	unkBits[off] &= ~mask;
+
+	if (state == ON)
+		onBits[off] |= mask;
+	else if (state == UNK)
+		unkBits[off] |= mask;
+}
+
+
+/*
+ * Determine all consequences of the cells which have been set but not
+ * yet examined, in the same way as the cell engine does.
+ * Returns ERROR if a contradiction was found, or OK if the cells are
+ * consistent.
+ */
+Status
+bitPropagate(void)
+{
+	Cell *	cell;
+	Status	status;
+	int	unit;
+	int	off;
+
+	for (;;)
+	{
+		while (nextSet != newSet)
+		{
+			cell = *nextSet++;
+			markCell(cell);
+
+			/*
+			 * The other cells of a loop were set along with it.
+			 */
+			if (cellLoop(cell) < 0)
+				continue;
+
+			for (off = cellLoop(cell); off != cellOffset(cell);
+				off = loopTable[off])
+			{
+				markCell(cellTable + off);
+			}
+		}
+
+		if (queueCount == 0)
+			return OK;
+
+		unit = queue[queueHead];
+
+		if (++queueHead == unitCount)
+			queueHead = 0;
+
+		queueCount--;
+
+		if (unit >= wrapUnits)
+			status = evalWrap(unit);
+		else
+			status = evalUnit(unit);
+
+		if (status != OK)
+		{
+			clearPending();
+
+			return ERROR;
+		}
+	}
+}
+
+
+/*
+ * Trigger the cells whose futures depend on a cell which has been set.
+ * These are the same pairs of cells and futures which the cell engine
+ * consistifies, namely the cell with its past, and its neighborhood
+ * with their futures.  The pairs which wrap around from the last
+ * generation to generation 0 are triggered by their future cells.
+ */
+static void
+markCell(const Cell * const cell)
+{
+	int	off;
+	int	unit;
+	int	col;
+	Bits	mask;
+
+	off = cellOffset(cell);
+	unit = off / colStride;
+	mask = ((Bits) 1) << (off % colStride);
+
+	if (off < genStride)
+		markFuture(off);
+	else
+		markBits(unit - planeCols, mask);
+
+	if (unit < wrapUnits)
+	{
+		mask |= (mask << 1) | (mask >> 1);
+		markBits(unit - 1, mask);
+		markBits(unit, mask);
+		markBits(unit + 1, mask);
+
+		return;
+	}
+
+	for (col = -1; col <= 1; col++)
+	{
+		markFuture(futureTable[off + col * colStride - 1]);
+		markFuture(futureTable[off + col * colStride]);
+		markFuture(futureTable[off + col * colStride + 1]);
+	}
+}
+
+
+/*
+ * Trigger the pair of a cell in generation 0 and its past.
+ * These pairs are kept in the units of the last generation,
+ * whose own futures are handled by these pairs.
+ */
+static void
+markFuture(const int off)
+{
+	markBits(wrapUnits + off / colStride, ((Bits) 1) << (off % colStride));
+}
+
+
+/*
+ * Trigger some cells of a unit, and queue the unit if necessary.
+ */
+static void
+markBits(const int unit, const Bits mask)
+{
+	if (pending[unit] == 0)
+	{
+		if (queueHead + queueCount < unitCount)
+			queue[queueHead + queueCount] = unit;
+		else
+			queue[queueHead + queueCount - unitCount] = unit;
+
+		queueCount++;
+	}
+
+	pending[unit] |= mask;
+}
+
+
+/*
+ * Forget all triggered cells after a contradiction.
+ */
+static void
+clearPending(void)
+{
+	while (queueCount > 0)
+	{
+		pending[queue[queueHead]] = 0;
+
+		if (++queueHead == unitCount)
+			queueHead = 0;
+
+		queueCount--;
+	}
+}
+
+
+/*
+ * Add three bit slices, giving the sum and carry slices.
+ */
+#define	fullAdd(sum, carry, a, b, c) \
+	{ Bits t_ = (a) ^ (b); (sum) = t_ ^ (c); \
+	(carry) = ((a) & (b)) | (t_ & (c)); }
+
+
+/*
+ * Count the eight neighbors of each cell of a unit as bit slices, given
+ * the columns to the left and right of the unit and the unit itself.
+ * The neighbors above and below a cell are found by shifting.
+ */
+static void
+countNeighbors(Bits * sum, const Bits left, const Bits mid, const Bits right)
+{
+	Bits	s1, s2, s3;
+	Bits	c1, c2, c3;
+	Bits	k1, t1;
+	Bits	d1, d2;
+
+	fullAdd(s1, c1, left << 1, left, left >> 1);
+	fullAdd(s2, c2, right << 1, right, right >> 1);
+	s3 = (mid << 1) ^ (mid >> 1);
+	c3 = (mid << 1) & (mid >> 1);
+	fullAdd(sum[0], k1, s1, s2, s3);
+	fullAdd(t1, d1, c1, c2, c3);
+	sum[1] = t1 ^ k1;
+	d2 = t1 & k1;
+	sum[2] = d1 ^ d2;
+	sum[3] = d1 & d2;
+}
+
+
+/*
+ * Return the cells whose counter holds the specified value.
+ */
+static Bits
+countIs(const Bits * sum, const int count)
+{
+	return ~((sum[0] ^ -(Bits) (count & 1)) |
+		(sum[1] ^ -(Bits) ((count >> 1) & 1)) |
+		(sum[2] ^ -(Bits) ((count >> 2) & 1)) |
+		(sum[3] ^ -(Bits) ((count >> 3) & 1)));
+}
+
+
+/*
+ * Return the value of the counter for one cell.
+ */
+static int
+sliceValue(const Bits * sum, const int bit)
+{
+	return ((sum[0] >> bit) & 1) | (((sum[1] >> bit) & 1) << 1) |
+		(((sum[2] >> bit) & 1) << 2) | (((sum[3] >> bit) & 1) << 3);
+}
+
+
+/*
+ * Note the contradictions found at the cells of a unit given by a mask,
+ * counting them for the heatmap and tracing the first of them.
+ */
+static void
+conflictBits(const Cell * const base, Bits mask)
+{
+	const Cell *	cell;
+
+	cell = base + __builtin_ctzll(mask);
+
+	TRACE(TRACE_CONFLICT, cell, (cell->state == UNK) ? UNK : 1 - cell->state,
+		FALSE);
+
+	if (!heatCounting)
+		return;
+
+	for (; mask; mask &= mask - 1)
+		heatConflict(base + __builtin_ctzll(mask));
+}
+
+
+/*
+ * Set the cells of a unit which are given by a mask to a state.
+ * Returns ERROR if any of them is already set to the other state.
+ */
+static Status
+setBits(Cell * const base, Bits mask, const State state)
+{
+	for (; mask; mask &= mask - 1)
+	{
+		if (setCell(base + __builtin_ctzll(mask), state, FALSE) != OK)
+			return ERROR;
+	}
+
+	return OK;
+}
+
+
+/*
+ * Evaluate the triggered cells of one unit against their futures.
+ * The future cells are set as the transit rules demand, and the cells
+ * and their unknown neighbors are set as the implic rules demand.
+ * Returns ERROR if a contradiction was found.
+ */
+static Status
+evalUnit(const int unit)
+{
+	Cell *	base;
+	Bits	trig;
+	Bits	onSum[4];
+	Bits	unkSum[4];
+	Bits	stateMask[nStates];
+	Bits	flagsOff[4];
+	Bits	flagsOn[4];
+	Bits	colOn;
+	Bits	colUnk;
+	Bits	xOn;
+	Bits	xUnk;
+	Bits	xOff;
+	Bits	xSetOn;
+	Bits	xSetOff;
+	Bits	tOn;
+	Bits	tOff;
+	Bits	pSetOn;
+	Bits	pSetOff;
+	Bits	un0;
+	Bits	un1;
+	Bits	setOn;
+	Bits	setOff;
+	Bits	left;
+	Bits	mask;
+	Rule	rule;
+	int	bit;
+	int	col;
+	int	i;
+	int	n;
+	int	u;
+	int	p;
+
+	trig = pending[unit];
+	pending[unit] = 0;
+
+	colOn = onBits[unit];
+	colUnk = unkBits[unit];
+	xOn = onBits[unit + planeCols] & trig;
+	xUnk = unkBits[unit + planeCols] & trig;
+
+	/*
+	 * Add up the eight neighbors of each cell as bit slices,
+	 * counting the ON and the unknown neighbors separately.
+	 */
+	countNeighbors(onSum, onBits[unit - 1], colOn, onBits[unit + 1]);
+	countNeighbors(unkSum, unkBits[unit - 1], colUnk, unkBits[unit + 1]);
+
+	stateMask[0] = trig & ~colOn & ~colUnk;
+	stateMask[1] = trig & colOn;
+	stateMask[2] = trig & colUnk;
+
+	/*
+	 * Apply the rules for each combination of state and neighbor
+	 * counts which occurs, to all of the cells with it at once.
+	 */
+	tOn = 0;
+	tOff = 0;
+	memset(flagsOff, 0, sizeof(flagsOff));
+	memset(flagsOn, 0, sizeof(flagsOn));
+
+	for (left = trig; left; left &= ~mask)
+	{
+		bit = __builtin_ctzll(left);
+		n = sliceValue(onSum, bit);
+		u = sliceValue(unkSum, bit);
+		p = ((colUnk >> bit) & 1) ? 2 : ((colOn >> bit) & 1);
+		mask = left & stateMask[p] & countIs(onSum, n) &
+			countIs(unkSum, u);
+		rule = rules[p][n][u];
+
+		if (rule & RULE_ON)
+			tOn |= mask;
+
+		if (rule & RULE_OFF)
+			tOff |= mask;
+
+		for (i = 0; i < 4; i++)
+		{
+			if (rule & (1 << (RULE_SHIFT_OFF + i)))
+				flagsOff[i] |= mask;
+
+			if (rule & (1 << (RULE_SHIFT_ON + i)))
+				flagsOn[i] |= mask;
+		}
+	}
+
+	/*
+	 * Check the future cells against the transitions,
+	 * and find the unknown ones which are now known.
+	 */
+	xOff = trig & ~xOn & ~xUnk;
+
+	if ((tOn & xOff) | (tOff & xOn))
+	{
+		if (heatCounting || tracing)
+			conflictBits(cellTable + (unit + planeCols) * colStride,
+				(tOn & xOff) | (tOff & xOn));
+
+		return ERROR;
+	}
+
+	xSetOn = xUnk & tOn;
+	xSetOff = xUnk & tOff;
+	xOn |= xSetOn;
+	xOff |= xSetOff;
+
+	/*
+	 * Collect the implications for the cells and their neighbors.
+	 * Forcing the unknown neighbors on takes priority over forcing
+	 * them off, as it does in the cell engine.
+	 */
+	pSetOff = (xOff & flagsOff[0]) | (xOn & flagsOn[0]);
+	pSetOn = (xOff & flagsOff[1]) | (xOn & flagsOn[1]);
+	un0 = (xOff & flagsOff[2]) | (xOn & flagsOn[2]);
+	un1 = (xOff & flagsOff[3]) | (xOn & flagsOn[3]);
+	un0 &= ~un1;
+
+	mask = (pSetOff & pSetOn) | (pSetOff & colOn) |
+		(pSetOn & ~colOn & ~colUnk);
+
+	if (mask)
+	{
+		if (heatCounting || tracing)
+			conflictBits(cellTable + unit * colStride, mask);
+
+		return ERROR;
+	}
+
+	base = cellTable + (unit + planeCols) * colStride;
+
+	if ((setBits(base, xSetOn, ON) != OK) ||
+		(setBits(base, xSetOff, OFF) != OK))
+	{
+		return ERROR;
+	}
+
+	/*
+	 * Spread the forcing of the neighbors over the three columns, and
+	 * then set the unknown cells.  A cell is not its own neighbor, but
+	 * it can be the neighbor of another cell in the same column.
+	 */
+	for (col = unit - 1; col <= unit + 1; col++)
+	{
+		setOn = (un1 << 1) | (un1 >> 1);
+		setOff = (un0 << 1) | (un0 >> 1);
+
+		if (col != unit)
+		{
+			setOn |= un1;
+			setOff |= un0;
+		}
+
+		setOn &= unkBits[col];
+		setOff &= unkBits[col];
+
+		if (col == unit)
+		{
+			setOn |= pSetOn;
+			setOff |= pSetOff;
+		}
+
+		if (setOn & setOff)
+		{
+			if (heatCounting || tracing)
+				conflictBits(cellTable + col * colStride, setOn & setOff);
+
+			return ERROR;
+		}
+
+		base = cellTable + col * colStride;
+
+		if ((setBits(base, setOn, ON) != OK) ||
+			(setBits(base, setOff, OFF) != OK))
+		{
+			return ERROR;
+		}
+	}
+
+	return OK;
+}
+
+
+/*
+ * Evaluate the triggered pairs which wrap around from the last generation
+ * to generation 0.  The past of a cell in generation 0 can be translated
+ * or flipped, so these pairs are checked one cell at a time using the
+ * neighbor counts kept in the cells, in the same way as the cell engine.
+ * Returns ERROR if a contradiction was found.
+ */
+static Status
+evalWrap(const int unit)
+{
+	Cell *	cell;
+	Cell *	prevCell;
+	Bits	mask;
+	Rule	rule;
+	State	state;
+	int	off;
+	int	i;
+	static const int	stateIndex[UNK + 1] = {0, 1, [UNK] = 2};
+
+	mask = pending[unit];
+	pending[unit] = 0;
+
+	for (; mask; mask &= mask - 1)
+	{
+		off = (unit - wrapUnits) * colStride + __builtin_ctzll(mask);
+		cell = cellTable + off;
+		prevCell = cellTable + pastTable[off];
+
+		rule = rules[stateIndex[prevCell->state]]
+			[prevCell->sumNear % UNK][prevCell->sumNear / UNK];
+
+		if (rule & RULE_ON)
+			state = ON;
+		else if (rule & RULE_OFF)
+			state = OFF;
+		else
+			state = UNK;
+
+		if (cell->state == UNK)
+		{
+			if (state == UNK)
+				continue;
+
+			if (setCell(cell, state, FALSE) != OK)
+				return ERROR;
+		}
+		else if ((cell->state ^ state) == ON)
+		{
+			TRACE(TRACE_CONFLICT, cell, state, FALSE);
+
+			if (heatCounting)
+				heatConflict(cell);
+
+			return ERROR;
+		}
+
+		rule >>= (cell->state == ON) ? RULE_SHIFT_ON : RULE_SHIFT_OFF;
+
+		if ((rule & N0IC0) && (setCell(prevCell, OFF, FALSE) != OK))
+			return ERROR;
+
+		if ((rule & N0IC1) && (setCell(prevCell, ON, FALSE) != OK))
+			return ERROR;
+
+		if (rule & (N0ICUN0 | N0ICUN1))
+		{
+			state = (rule & N0ICUN1) ? ON : OFF;
+
+			for (i = 0; i < 9; i++)
+			{
+				cell = prevCell + (i / 3 - 1) * colStride + i % 3 - 1;
+
+				if ((i != 4) && (cell->state == UNK) &&
+					(setCell(cell, state, FALSE) != OK))
+				{
+					return ERROR;
+				}
+			}
+		}
+	}
+
+	return OK;
+}
+
+/* END CODE */
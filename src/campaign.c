@@ -0,0 +1,557 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <pthread.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "lifeapi.h"
+#include "campaign.h"
+
+/*
+ * Campaigns of many searches.
+ * Every initial file (ending in ".lif") found below a directory is a job,
+ * which is searched using its size and the options given for the whole
+ * campaign.  The jobs are run by a pool of worker threads within this
+ * process, each search writing its objects to a file named after the job
+ * and ending in ".out".  Each search is checkpointed to a dump file which
+ * ends in ".dmp", and the status of every job is kept in an index file in
+ * the directory.  Running the campaign again skips the jobs which are
+ * done and continues the others from their dump files.
+ */
+
+#define	INDEX_FILE	"campaign.idx"	/* name of the index file */
+
+/*
+ * Status of a job.
+ */
+#define	JOB_TODO	0	/* not yet done */
+#define	JOB_RUNNING	1	/* being searched */
+#define	JOB_FOUND	2	/* objects were found */
+#define	JOB_NONE	3	/* no objects exist */
+#define	JOB_ERROR	4	/* the search could not be set up */
+#define	JOB_STATES	5
+
+static const char * const jobNames[JOB_STATES] =
+{
+	"todo", "running", "found", "none", "error"
+};
+
+
+typedef struct
+{
+	char *		path;		/* path of the initial file */
+	int		status;		/* status of the job */
+	LifeSearch *	life;		/* search while it is running */
+} Job;
+
+
+static const char *	campaignDir;	/* directory of the campaign */
+static char **		commonArgs;	/* options for every search */
+static int		commonCount;	/* number of those options */
+static Bool		allFound;	/* all objects are wanted */
+static Job *		jobs;		/* table of jobs */
+static int		jobCount;	/* number of jobs */
+static int		jobMax;		/* allocated size of the table */
+static int		nextJob;	/* next job to look at for work */
+static int		doneCount;	/* number of jobs finished */
+static int		busyCount;	/* number of workers still running */
+static pthread_mutex_t	campaignLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static int	addJob(const char *, const struct stat *, int, struct FTW *);
+static int	jobSortFunc(const void *, const void *);
+static Job *	findJob(const char *);
+static void	readIndex(void);
+static void	writeIndex(void);
+static void *	campaignWorker(void *);
+static int	runJob(Job *);
+static Bool	lifSize(const char *, int *, int *);
+
+
+/*
+ * Run a campaign from arguments like those of the command line, which
+ * follow the --campaign option.  The first argument is the directory,
+ * -jN sets the number of workers, -dN sets the number of seconds between
+ * checkpoints, and the rest are the options for every search.
+ * Returns the exit status for the program.
+ */
+int
+runCampaign(int argc, char ** argv)
+{
+	pthread_t *	threads;
+	int		workerCount;
+	int		checkpoint;
+	int		seconds;
+	int		counts[JOB_STATES];
+	int		i;
+
+	if ((argc <= 0) || (**argv == '-'))
+	{
+		fprintf(stderr, "Missing campaign directory\n");
+
+		return 1;
+	}
+
+	campaignDir = *argv++;
+	argc--;
+
+	workerCount = sysconf(_SC_NPROCESSORS_ONLN);
+	checkpoint = 600;
+
+	commonArgs = (char **) malloc(sizeof(char *) * (argc + 1));
+
+	if (commonArgs == NULL)
+		fatal("Cannot allocate campaign");
+
+	while (argc-- > 0)
+	{
+		if (strncmp(*argv, "-j", 2) == 0)
+			workerCount = atoi(*argv + 2);
+		else if (strncmp(*argv, "-d", 2) == 0)
+			checkpoint = atoi(*argv + 2);
+		else
+		{
+			if (strcmp(*argv, "-a") == 0)
+				allFound = TRUE;
+
+			commonArgs[commonCount++] = *argv;
+		}
+
+		argv++;
+	}
+
+	if (workerCount < 1)
+		workerCount = 1;
+
+	/*
+	 * Find the jobs in a fixed order, and then pick up their status
+	 * from the last time the campaign was run.
+	 */
+	if (nftw(campaignDir, addJob, 16, FTW_PHYS) != 0)
+	{
+		fprintf(stderr, "Cannot read campaign directory \"%s\"\n",
+			campaignDir);
+
+		return 1;
+	}
+
+	qsort(jobs, jobCount, sizeof(Job), jobSortFunc);
+
+	readIndex();
+	writeIndex();
+
+	for (i = 0; i < jobCount; i++)
+	{
+		if (jobs[i].status > JOB_RUNNING)
+			doneCount++;
+	}
+
+	printf("Campaign has %d jobs, %d already done\n", jobCount, doneCount);
+	fflush(stdout);
+
+	threads = (pthread_t *) malloc(sizeof(pthread_t) * workerCount);
+
+	if (threads == NULL)
+		fatal("Cannot allocate campaign");
+
+	busyCount = workerCount;
+
+	for (i = 0; i < workerCount; i++)
+	{
+		if (pthread_create(&threads[i], NULL, campaignWorker, NULL))
+			fatal("Cannot create campaign worker");
+	}
+
+	/*
+	 * Wait for the workers, asking the running searches to checkpoint
+	 * themselves every so often.
+	 */
+	seconds = 0;
+
+	for (;;)
+	{
+		sleep(1);
+		seconds++;
+
+		pthread_mutex_lock(&campaignLock);
+
+		if (busyCount == 0)
+		{
+			pthread_mutex_unlock(&campaignLock);
+
+			break;
+		}
+
+		if ((checkpoint > 0) && ((seconds % checkpoint) == 0))
+		{
+			for (i = 0; i < jobCount; i++)
+			{
+				if (jobs[i].life)
+					lifeDump(jobs[i].life);
+			}
+		}
+
+		pthread_mutex_unlock(&campaignLock);
+	}
+
+	for (i = 0; i < workerCount; i++)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+
+	memset(counts, 0, sizeof(counts));
+
+	for (i = 0; i < jobCount; i++)
+		counts[jobs[i].status]++;
+
+	printf("Campaign completed: %d found, %d none, %d errors, %d left\n",
+		counts[JOB_FOUND], counts[JOB_NONE], counts[JOB_ERROR],
+		counts[JOB_TODO] + counts[JOB_RUNNING]);
+
+	return (counts[JOB_ERROR] > 0);
+}
+
+
+/*
+ * Add a job for a file found in the campaign directory if it is an
+ * initial file.
+ */
+static int
+addJob(const char * path, const struct stat * sb, int type, struct FTW * ftw)
+{
+	int	len = strlen(path);
+
+	if ((type != FTW_F) || (len < 4) || strcmp(path + len - 4, ".lif"))
+		return 0;
+
+	if (jobCount >= jobMax)
+	{
+		jobMax = jobMax * 2 + 64;
+		jobs = (Job *) realloc(jobs, sizeof(Job) * jobMax);
+
+		if (jobs == NULL)
+			fatal("Cannot allocate jobs");
+	}
+
+	jobs[jobCount].path = strdup(path);
+	jobs[jobCount].status = JOB_TODO;
+	jobs[jobCount].life = NULL;
+
+	if (jobs[jobCount].path == NULL)
+		fatal("Cannot allocate jobs");
+
+	jobCount++;
+
+	return 0;
+}
+
+
+/*
+ * Sort the jobs by their paths, with numbers in numeric order.
+ */
+static int
+jobSortFunc(const void * a, const void * b)
+{
+	return strverscmp(((const Job *) a)->path, ((const Job *) b)->path);
+}
+
+
+/*
+ * Find the job with the specified path, or NULL if there is none.
+ */
+static Job *
+findJob(const char * path)
+{
+	Job	key;
+
+	key.path = (char *) path;
+
+	return (Job *) bsearch(&key, jobs, jobCount, sizeof(Job), jobSortFunc);
+}
+
+
+/*
+ * Read the status of the jobs from the index file if there is one.
+ * Jobs which were running or had errors are done again, from their
+ * dump files if they have them.
+ */
+static void
+readIndex(void)
+{
+	FILE *	fp;
+	Job *	job;
+	char	buf[4096];
+	char	path[4096];
+	char	name[16];
+	int	status;
+
+	snprintf(buf, sizeof(buf), "%s/%s", campaignDir, INDEX_FILE);
+
+	fp = fopen(buf, "r");
+
+	if (fp == NULL)
+		return;
+
+	while (fgets(buf, sizeof(buf), fp))
+	{
+		if (sscanf(buf, "%15s %4095[^\n]", name, path) != 2)
+			continue;
+
+		job = findJob(path);
+
+		if (job == NULL)
+			continue;
+
+		for (status = JOB_FOUND; status <= JOB_NONE; status++)
+		{
+			if (strcmp(name, jobNames[status]) == 0)
+				job->status = status;
+		}
+	}
+
+	fclose(fp);
+}
+
+
+/*
+ * Write the status of all of the jobs to the index file.
+ * The file is replaced all at once, so that it is always complete.
+ * This is called with the campaign locked, except at the start.
+ */
+static void
+writeIndex(void)
+{
+	FILE *	fp;
+	char	file[4000];
+	char	tmpFile[4096];
+	int	i;
+
+	snprintf(file, sizeof(file), "%s/%s", campaignDir, INDEX_FILE);
+	snprintf(tmpFile, sizeof(tmpFile), "%s.tmp", file);
+
+	fp = fopen(tmpFile, "w");
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Cannot create \"%s\"\n", tmpFile);
+
+		return;
+	}
+
+	for (i = 0; i < jobCount; i++)
+		fprintf(fp, "%s %s\n", jobNames[jobs[i].status], jobs[i].path);
+
+	if (fclose(fp) || rename(tmpFile, file))
+		fprintf(stderr, "Cannot write \"%s\"\n", file);
+}
+
+
+/*
+ * A worker of a campaign.
+ * It runs the jobs which are not yet done one after another until
+ * there are no more of them.
+ */
+static void *
+campaignWorker(void * arg)
+{
+	Job *	job;
+	int	status;
+
+	pthread_mutex_lock(&campaignLock);
+
+	for (;;)
+	{
+		while ((nextJob < jobCount) && (jobs[nextJob].status != JOB_TODO))
+			nextJob++;
+
+		if (nextJob >= jobCount)
+			break;
+
+		job = &jobs[nextJob++];
+		job->status = JOB_RUNNING;
+		writeIndex();
+
+		pthread_mutex_unlock(&campaignLock);
+
+		status = runJob(job);
+
+		pthread_mutex_lock(&campaignLock);
+
+		job->status = status;
+		doneCount++;
+		writeIndex();
+
+		printf("Job %d of %d \"%s\": %s\n", doneCount, jobCount,
+			job->path, jobNames[status]);
+		fflush(stdout);
+	}
+
+	busyCount--;
+
+	pthread_mutex_unlock(&campaignLock);
+
+	return NULL;
+}
+
+
+/*
+ * Run the search for one job, either from the start or from its dump
+ * file if there is one.
+ * Returns the new status of the job.
+ */
+static int
+runJob(Job * job)
+{
+	LifeSearch *	life;
+	char **		args;
+	char		base[4000];
+	char		dumpPath[4096];
+	char		outPath[4096];
+	char		rowArg[16];
+	char		colArg[16];
+	int		count;
+	int		rows;
+	int		cols;
+	Bool		found;
+	Status		status;
+
+	snprintf(base, sizeof(base), "%.*s",
+		(int) strlen(job->path) - 4, job->path);
+	snprintf(dumpPath, sizeof(dumpPath), "%s.dmp", base);
+	snprintf(outPath, sizeof(outPath), "%s.out", base);
+
+	args = (char **) malloc(sizeof(char *) * (commonCount + 8));
+
+	if (args == NULL)
+		fatal("Cannot allocate campaign");
+
+	memcpy(args, commonArgs, sizeof(char *) * commonCount);
+	count = commonCount;
+
+	if (access(dumpPath, R_OK) == 0)
+	{
+		args[count++] = "-l";
+		args[count++] = dumpPath;
+	}
+	else
+	{
+		if (!lifSize(job->path, &rows, &cols))
+		{
+			fprintf(stderr, "Cannot read \"%s\"\n", job->path);
+			free(args);
+
+			return JOB_ERROR;
+		}
+
+		sprintf(rowArg, "-r%d", rows);
+		sprintf(colArg, "-c%d", cols);
+
+		args[count++] = rowArg;
+		args[count++] = colArg;
+		args[count++] = "-i";
+		args[count++] = job->path;
+	}
+
+	args[count++] = "-d0";
+	args[count++] = dumpPath;
+	args[count++] = "-o";
+	args[count++] = outPath;
+
+	life = lifeCreate(NULL, NULL);
+
+	if (life == NULL)
+		fatal("Cannot create search");
+
+	status = lifeConfigure(life, count, args);
+
+	if (status == NOT_EXIST)
+	{
+		lifeDestroy(life);
+		free(args);
+
+		return JOB_NONE;
+	}
+
+	if (status != OK)
+	{
+		fprintf(stderr, "Job \"%s\": %s\n", job->path, lifeError(life));
+		lifeDestroy(life);
+		free(args);
+
+		return JOB_ERROR;
+	}
+
+	pthread_mutex_lock(&campaignLock);
+	job->life = life;
+	pthread_mutex_unlock(&campaignLock);
+
+	found = FALSE;
+
+	while (lifeStep(life) == FOUND)
+	{
+		found = TRUE;
+
+		if (!allFound)
+			break;
+	}
+
+	pthread_mutex_lock(&campaignLock);
+	job->life = NULL;
+	pthread_mutex_unlock(&campaignLock);
+
+	lifeDestroy(life);
+	free(args);
+
+	/*
+	 * A search resumed from its dump may have found its objects before.
+	 */
+	if (!found && (access(outPath, F_OK) == 0))
+		found = TRUE;
+
+	return found ? JOB_FOUND : JOB_NONE;
+}
+
+
+/*
+ * Get the number of rows and columns of an initial file, which are the
+ * number of its lines and the length of its longest line.
+ * Returns TRUE if the file could be read.
+ */
+static Bool
+lifSize(const char * file, int * rows, int * cols)
+{
+	FILE *	fp;
+	char	buf[4096];
+	int	len;
+
+	fp = fopen(file, "r");
+
+	if (fp == NULL)
+		return FALSE;
+
+	*rows = 0;
+	*cols = 0;
+
+	while (fgets(buf, sizeof(buf), fp))
+	{
+		len = strcspn(buf, "\r\n");
+
+		if (len == 0)
+			continue;
+
+		(*rows)++;
+
+		if (len > *cols)
+			*cols = len;
+	}
+
+	fclose(fp);
+
+	return (*rows > 0);
+}
+
+/* END CODE */
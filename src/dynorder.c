@@ -0,0 +1,336 @@
+#include <stdlib.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "dynorder.h"
+
+/*
+ * Dynamic search order.
+ * Instead of following the fixed search list, the next cell chosen is
+ * the unknown one which is most constrained at the moment, which is the
+ * one with the fewest unknown cells around it in the previous generation,
+ * since those are the cells which determine its state.  Cells with equal
+ * scores are taken in the order of the search list.  The unknown cells
+ * are kept in a heap ordered by their scores.  Setting or clearing a cell
+ * only marks the cells whose scores it changes, and the heap is brought
+ * up to date for just those cells when the next cell is to be chosen, so
+ * that the many settings which are undone again by backing up cost
+ * little, and choosing a cell never needs a scan of the cells.
+ */
+
+static SEARCH_LOCAL Cell ** dynList;		/* the search list */
+static SEARCH_LOCAL int dynCount;		/* number of cells in the search list */
+static SEARCH_LOCAL int * dynHeap;		/* search list indexes of the heap */
+static SEARCH_LOCAL int * dynPos;		/* heap position of each index, or -1 */
+static SEARCH_LOCAL int * dynKey;		/* key of each index in the heap */
+static SEARCH_LOCAL int heapCount;		/* number of cells in the heap */
+static SEARCH_LOCAL int * dynDirty;		/* indexes whose cells have changed */
+static SEARCH_LOCAL char * dynMark;		/* whether each index is in the dirty list */
+static SEARCH_LOCAL int dirtyCount;		/* number of indexes in the dirty list */
+
+static int dynScore(const Cell * const);
+static void dynSet(const int, const int);
+static void dynUp(int);
+static void dynDown(int);
+static void dynInsert(const int);
+static void dynRemove(const int);
+static void dynRekey(const int);
+static void dynTouch(const Cell * const);
+
+
+/*
+ * Start the dynamic order using the specified search list.  Only the cells
+ * which are unknown are put in the heap, and the others are added when
+ * they are cleared.
+ */
+void
+dynInit(Cell ** const list, const int count)
+{
+	int	i;
+
+	free(dynHeap);
+	free(dynPos);
+	free(dynKey);
+	free(dynDirty);
+	free(dynMark);
+
+	dynList = list;
+	dynCount = count;
+	dynHeap = (int *) malloc(sizeof(int) * (count + 1));
+	dynPos = (int *) malloc(sizeof(int) * (count + 1));
+	dynKey = (int *) malloc(sizeof(int) * (count + 1));
+	dynDirty = (int *) malloc(sizeof(int) * (count + 1));
+	dynMark = (char *) calloc(count + 1, sizeof(char));
+
+	if ((dynHeap == NULL) || (dynPos == NULL) || (dynKey == NULL) ||
+		(dynDirty == NULL) || (dynMark == NULL))
+	{
+		fatal("Cannot allocate search heap");
+	}
+
+	heapCount = 0;
+	dirtyCount = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		dynPos[i] = -1;
+
+		if (list[i]->state != UNK)
+			continue;
+
+		dynKey[i] = dynScore(list[i]) * count + i;
+		dynSet(heapCount++, i);
+	}
+
+	for (i = heapCount / 2 - 1; i >= 0; i--)
+		dynDown(i);
+}
+
+
+/*
+ * Free the heap of the dynamic order.
+ */
+void
+dynFree(void)
+{
+	free(dynHeap);
+	free(dynPos);
+	free(dynKey);
+	free(dynDirty);
+	free(dynMark);
+
+	dynHeap = NULL;
+	dynPos = NULL;
+	dynKey = NULL;
+	dynDirty = NULL;
+	dynMark = NULL;
+}
+
+
+/*
+ * Note a change of the state of a cell, which has already been made
+ * along with the sums of its neighbors.  The cell itself and the cells
+ * whose previous generation is next to it are marked to be looked at
+ * again when the next cell is chosen.
+ */
+void
+dynUpdate(Cell * const cell, const State oldState)
+{
+	Cell *	near;
+	int	i;
+
+	if ((dynHeap == NULL) || ((oldState == UNK) == (cell->state == UNK)))
+		return;
+
+	dynTouch(cell);
+
+	for (i = -1; i <= 1; i++)
+	{
+		near = cell + i * colStride;
+
+		dynTouch(cellFuture(near - 1));
+		dynTouch(cellFuture(near));
+		dynTouch(cellFuture(near + 1));
+	}
+}
+
+
+/*
+ * Return the most constrained unknown cell which can be chosen.
+ * Cells which can no longer be chosen are dropped from the heap.
+ * Returns NULL_CELL if there are no more unknown cells.
+ */
+Cell *
+dynFirst(void)
+{
+	Cell *	cell;
+	int	idx;
+
+	/*
+	 * Bring the heap up to date for the cells which have changed.
+	 */
+	while (dirtyCount > 0)
+	{
+		idx = dynDirty[--dirtyCount];
+		dynMark[idx] = 0;
+		cell = dynList[idx];
+
+		if (cell->state != UNK)
+		{
+			if (dynPos[idx] >= 0)
+				dynRemove(idx);
+		}
+		else if (dynPos[idx] >= 0)
+			dynRekey(idx);
+		else if (cell->flags & CHOOSECELL)
+			dynInsert(idx);
+	}
+
+	while (heapCount > 0)
+	{
+		cell = dynList[dynHeap[0]];
+
+		if (cell->flags & CHOOSECELL)
+			return cell;
+
+		dynRemove(dynHeap[0]);
+	}
+
+	return NULL_CELL;
+}
+
+
+/*
+ * Return the number of unknown cells around a cell in the previous
+ * generation.  Since an unknown state is larger than the sum of all of
+ * the ON states, this is just the quotient of the sum of their states.
+ */
+static int
+dynScore(const Cell * const cell)
+{
+	const Cell *	past = cellPast(cell);
+
+	return (past->sumNear + past->state) / UNK;
+}
+
+
+/*
+ * Put a search list index at the specified position of the heap.
+ */
+static void
+dynSet(const int pos, const int idx)
+{
+	dynHeap[pos] = idx;
+	dynPos[idx] = pos;
+}
+
+
+/*
+ * Move the entry at a heap position up towards the top until its parent
+ * is not larger.
+ */
+static void
+dynUp(int pos)
+{
+	int	idx = dynHeap[pos];
+	int	parentPos;
+
+	while (pos > 0)
+	{
+		parentPos = (pos - 1) / 2;
+
+		if (dynKey[dynHeap[parentPos]] <= dynKey[idx])
+			break;
+
+		dynSet(pos, dynHeap[parentPos]);
+		pos = parentPos;
+	}
+
+	dynSet(pos, idx);
+}
+
+
+/*
+ * Move the entry at a heap position down until its children are not
+ * smaller.
+ */
+static void
+dynDown(int pos)
+{
+	int	idx = dynHeap[pos];
+	int	child;
+
+	for (;;)
+	{
+		child = pos * 2 + 1;
+
+		if (child >= heapCount)
+			break;
+
+		if ((child + 1 < heapCount) &&
+			(dynKey[dynHeap[child + 1]] < dynKey[dynHeap[child]]))
+		{
+			child++;
+		}
+
+		if (dynKey[idx] <= dynKey[dynHeap[child]])
+			break;
+
+		dynSet(pos, dynHeap[child]);
+		pos = child;
+	}
+
+	dynSet(pos, idx);
+}
+
+
+/*
+ * Add a search list index to the heap.
+ */
+static void
+dynInsert(const int idx)
+{
+	dynKey[idx] = dynScore(dynList[idx]) * dynCount + idx;
+	dynSet(heapCount++, idx);
+	dynUp(heapCount - 1);
+}
+
+
+/*
+ * Remove a search list index from the heap.
+ */
+static void
+dynRemove(const int idx)
+{
+	int	pos = dynPos[idx];
+	int	last = dynHeap[--heapCount];
+
+	dynPos[idx] = -1;
+
+	if (pos == heapCount)
+		return;
+
+	dynSet(pos, last);
+	dynUp(pos);
+	dynDown(dynPos[last]);
+}
+
+
+/*
+ * Recompute the score of a search list index which is in the heap, and
+ * move it to its new place.
+ */
+static void
+dynRekey(const int idx)
+{
+	int	key = dynScore(dynList[idx]) * dynCount + idx;
+
+	if (key < dynKey[idx])
+	{
+		dynKey[idx] = key;
+		dynUp(dynPos[idx]);
+	}
+	else if (key > dynKey[idx])
+	{
+		dynKey[idx] = key;
+		dynDown(dynPos[idx]);
+	}
+}
+
+
+/*
+ * Mark a cell as changed if it is in the search list.
+ */
+static void
+dynTouch(const Cell * const cell)
+{
+	int	idx = cellIndex(cell);
+
+	if ((idx < 0) || dynMark[idx])
+		return;
+
+	dynMark[idx] = 1;
+	dynDirty[dirtyCount++] = idx;
+}
+
+/* END CODE */
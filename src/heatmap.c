@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "heatmap.h"
+
+/*
+ * Heatmaps of where the work of a search is done.
+ * For each cell, the number of times it was chosen, the number of times
+ * it was forced by other cells or by backing up, and the number of times
+ * it was the site of a contradiction are counted.  These are written on
+ * demand as a table of comma separated values for all of the cells, and
+ * as a grey map image of the contradictions for each generation, which
+ * show whether the search area should be made smaller, cells should be
+ * excluded, or the search order changed.  The counting is only done when
+ * asked for, and can be compiled out completely using HEAT_FLAG.
+ */
+
+#define	HEAT_DECIDE	0	/* cell was chosen */
+#define	HEAT_FORCE	1	/* cell was forced */
+#define	HEAT_CONFLICT	2	/* cell was the site of a contradiction */
+#define	HEAT_KINDS	3	/* number of counts for each cell */
+
+
+static void	writeImage(const char *, const int, const unsigned long);
+
+
+/*
+ * Allocate the table of counts for the current size of the search.
+ */
+void
+heatInit(void)
+{
+	free(heatTable);
+	heatTable = (unsigned long *) calloc(genStride * genMax * HEAT_KINDS,
+		sizeof(unsigned long));
+
+	if (heatTable == NULL)
+		fatal("Cannot allocate heatmap");
+}
+
+
+/*
+ * Free the table of counts.
+ */
+void
+heatFree(void)
+{
+	free(heatTable);
+	heatTable = NULL;
+}
+
+
+/*
+ * Count the cells which have been set starting at a point of the setting
+ * table.  The first one was chosen if it was free, and the others were all
+ * forced.
+ */
+void
+heatSettings(Cell ** mark, const Bool free)
+{
+	if (mark == newSet)
+		return;
+
+	heatTable[cellOffset(*mark++) * HEAT_KINDS +
+		(free ? HEAT_DECIDE : HEAT_FORCE)]++;
+
+	while (mark != newSet)
+		heatTable[cellOffset(*mark++) * HEAT_KINDS + HEAT_FORCE]++;
+}
+
+
+/*
+ * Count a contradiction found at a cell.
+ */
+void
+heatConflict(const Cell * const cell)
+{
+	heatTable[cellOffset(cell) * HEAT_KINDS + HEAT_CONFLICT]++;
+}
+
+
+/*
+ * Write the counts of all of the cells to the file named by the prefix
+ * followed by ".csv", and the images of the contradictions in each
+ * generation to the files named by the prefix followed by ".gN.pgm".
+ */
+void
+writeHeat(const char * prefix)
+{
+	FILE *		fp;
+	const unsigned long *	counts;
+	unsigned long	most;
+	char		name[1024];
+	int		row;
+	int		col;
+	int		gen;
+
+	if (heatTable == NULL)
+	{
+		ttyStatus("Cells are not being counted, use -H\n");
+
+		return;
+	}
+
+	snprintf(name, sizeof(name), "%s.csv", prefix);
+	fp = fopen(name, "w");
+
+	if (fp == NULL)
+	{
+		ttyStatus("Cannot create \"%s\"\n", name);
+
+		return;
+	}
+
+	fprintf(fp, "row,col,gen,decisions,forced,conflicts\n");
+	most = 0;
+
+	for (gen = 0; gen < genMax; gen++)
+		for (row = 1; row <= rowMax; row++)
+			for (col = 1; col <= colMax; col++)
+	{
+		counts = &heatTable[cellOffset(findCell(row, col, gen)) *
+			HEAT_KINDS];
+
+		fprintf(fp, "%d,%d,%d,%lu,%lu,%lu\n", row, col, gen,
+			counts[HEAT_DECIDE], counts[HEAT_FORCE],
+			counts[HEAT_CONFLICT]);
+
+		if (counts[HEAT_CONFLICT] > most)
+			most = counts[HEAT_CONFLICT];
+	}
+
+	fclose(fp);
+
+	/*
+	 * All of the images use the same scale so that the generations
+	 * can be compared with each other.
+	 */
+	for (gen = 0; gen < genMax; gen++)
+	{
+		snprintf(name, sizeof(name), "%s.g%d.pgm", prefix, gen);
+		writeImage(name, gen, most);
+	}
+
+	ttyStatus("Heatmap written to \"%s.csv\"\n", prefix);
+}
+
+
+/*
+ * Write an image of the contradictions of one generation, where white is
+ * the most contradictions of any cell.
+ */
+static void
+writeImage(const char * name, const int gen, const unsigned long most)
+{
+	FILE *	fp;
+	unsigned long	count;
+	int	row;
+	int	col;
+
+	fp = fopen(name, "wb");
+
+	if (fp == NULL)
+	{
+		ttyStatus("Cannot create \"%s\"\n", name);
+
+		return;
+	}
+
+	fprintf(fp, "P5\n%d %d\n255\n", colMax, rowMax);
+
+	for (row = 1; row <= rowMax; row++)
+	{
+		for (col = 1; col <= colMax; col++)
+		{
+			count = heatTable[cellOffset(findCell(row, col, gen)) *
+				HEAT_KINDS + HEAT_CONFLICT];
+
+			putc(most ? (int) ((count * 255 + most / 2) / most) : 0,
+				fp);
+		}
+	}
+
+	fclose(fp);
+}
+
+/* END CODE */
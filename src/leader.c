@@ -0,0 +1,400 @@
+#include <stdlib.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "leader.h"
+
+/*
+ * Breaking of the symmetries of the grid.
+ * Without any enforced symmetry, an object and its reflections or
+ * rotations are usually all found, which can multiply the work of the
+ * search by up to eight.  Each symmetry of the grid which keeps all of the
+ * settings and limits of the search the same, and which commutes with the
+ * translating and flipping between the last and the first generations,
+ * maps every object to another object.  So only the objects of generation
+ * 0 which are no larger than all of their images are needed, comparing
+ * the cells in a fixed order with OFF less than ON, which leaves exactly
+ * one object of each set of images.  The comparison is checked whenever a
+ * cell of generation 0 is set, and fails as soon as the first cell which
+ * differs from its image is ON while its image is OFF.
+ */
+
+#define	SYM_COUNT	8	/* symmetries of a square grid */
+
+
+static SEARCH_LOCAL Cell **	leaderCells;	/* cells of gen 0 in fixed order */
+static SEARCH_LOCAL Cell **	leaderImages;	/* images of those cells */
+static SEARCH_LOCAL int		cellTotal;	/* number of cells of gen 0 */
+static SEARCH_LOCAL int		symTotal;	/* number of symmetries broken */
+
+static Cell *	symImage(const Cell * const, const int);
+static void	symCoords(const int, int *, int *);
+static Bool	symAllowed(const int);
+static Bool	inLoop(const Cell * const, const Cell * const);
+static void	leaderBuild(void);
+
+
+/*
+ * Remember the cells of generation 0 in the order they appear in the
+ * search list, which is the order in which they are compared with their
+ * images, and then make the images of the symmetries already known.
+ * The order must stay the same for the whole search, even when loaded
+ * again from a dump, so it is taken before any reordering for restarts.
+ */
+void
+leaderInit(Cell ** const list, const int count)
+{
+	int	i;
+
+	free(leaderCells);
+	leaderCells = (Cell **) malloc(sizeof(Cell *) * (rowMax * colMax + 1));
+
+	if (leaderCells == NULL)
+		fatal("Cannot allocate symmetry table");
+
+	cellTotal = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		if (cellGen(list[i]) == 0)
+			leaderCells[cellTotal++] = list[i];
+	}
+
+	leaderBuild();
+}
+
+
+/*
+ * Find the symmetries to break when the search is about to begin, after
+ * all of the initial settings are made.  Nothing is done if they are
+ * already known, such as when the search was loaded from a dump, or if
+ * breaking symmetries was turned off.  Symmetries are not broken together
+ * with enforced symmetries, or when some cells of generation 0 have been
+ * left out of the search.
+ */
+void
+leaderStart(void)
+{
+	int	sym;
+
+	if (symMask != SYM_FIND)
+		return;
+
+	symMask = 0;
+
+	if (rowSym || colSym || pointSym || fwdSym || bwdSym ||
+		(cellTotal != rowMax * colMax))
+	{
+		return;
+	}
+
+	for (sym = 1; sym < SYM_COUNT; sym++)
+	{
+		if (symAllowed(sym))
+			symMask |= (1 << sym);
+	}
+	leaderBuild();
+}
+
+
+/*
+ * Free the tables of the symmetries.
+ */
+void
+leaderFree(void)
+{
+	free(leaderCells);
+	free(leaderImages);
+	leaderCells = NULL;
+	leaderImages = NULL;
+	cellTotal = 0;
+	symTotal = 0;
+}
+
+
+/*
+ * Return whether the cells of generation 0 can still be no larger than
+ * each of their images.  The cells are compared in order until one of
+ * them or its image is unknown, or they differ.
+ */
+Bool
+leaderOk(void)
+{
+	Cell **	images;
+	State	state;
+	State	image;
+	int	sym;
+	int	i;
+
+	for (sym = 0; sym < symTotal; sym++)
+	{
+		images = &leaderImages[sym * cellTotal];
+
+		for (i = 0; i < cellTotal; i++)
+		{
+			state = leaderCells[i]->state;
+			image = images[i]->state;
+
+			if (state != image)
+			{
+				if ((state == ON) && (image == OFF))
+					return FALSE;
+
+				break;
+			}
+
+			if (state == UNK)
+				break;
+		}
+	}
+
+	return TRUE;
+}
+
+
+/*
+ * Make the table of the images of the cells for each symmetry being
+ * broken.
+ */
+static void
+leaderBuild(void)
+{
+	Cell **	images;
+	int	sym;
+	int	i;
+
+	free(leaderImages);
+	leaderImages = NULL;
+	symTotal = 0;
+
+	if (symMask <= 0)
+		return;
+
+	leaderImages = (Cell **) malloc(sizeof(Cell *) * SYM_COUNT * cellTotal);
+
+	if (leaderImages == NULL)
+		fatal("Cannot allocate symmetry table");
+
+	for (sym = 1; sym < SYM_COUNT; sym++)
+	{
+		if ((symMask & (1 << sym)) == 0)
+			continue;
+
+		images = &leaderImages[symTotal++ * cellTotal];
+
+		for (i = 0; i < cellTotal; i++)
+			images[i] = symImage(leaderCells[i], sym);
+	}
+}
+
+
+/*
+ * Return whether a symmetry maps every object of the search to another
+ * object of the search.  The symmetry has to keep the limits of generation
+ * 0 and all of the settings of the cells the same, and has to give the
+ * same result whether it is applied before or after mapping the last
+ * generation to the first one.
+ */
+static Bool
+symAllowed(const int sym)
+{
+	Cell *	cell;
+	Cell *	image;
+	int	row1;
+	int	col1;
+	int	row2;
+	int	col2;
+	int	row;
+	int	col;
+	int	gen;
+
+	if ((sym >= 4) && (rowMax != colMax))
+		return FALSE;
+
+	/*
+	 * Check the limits on rows and columns of generation 0.
+	 * The limits on columns need columns to stay columns, and -nc also
+	 * needs each column to stay in its place.
+	 */
+	row1 = 1;
+	col1 = 1;
+	row2 = rowMax;
+	col2 = 1;
+	symCoords(sym, &row1, &col1);
+	symCoords(sym, &row2, &col2);
+
+	if ((colCells || colWidth || nearCols) && (col1 != col2))
+		return FALSE;
+
+	if (nearCols && (col1 != 1))
+		return FALSE;
+
+	if (useRow)
+	{
+		row1 = useRow;
+		col1 = 1;
+		row2 = useRow;
+		col2 = colMax;
+		symCoords(sym, &row1, &col1);
+		symCoords(sym, &row2, &col2);
+
+		if ((row1 != useRow) || (row2 != useRow))
+			return FALSE;
+	}
+
+	if (useCol)
+	{
+		row1 = 1;
+		col1 = useCol;
+		row2 = rowMax;
+		col2 = useCol;
+		symCoords(sym, &row1, &col1);
+		symCoords(sym, &row2, &col2);
+
+		if ((col1 != useCol) || (col2 != useCol))
+			return FALSE;
+	}
+
+	/*
+	 * Check the mapping between the last and the first generations for
+	 * the cells of the active area.  The cells around it are always OFF,
+	 * so their mapping does not matter.
+	 */
+	for (row = 1; row <= rowMax; row++)
+		for (col = 1; col <= colMax; col++)
+	{
+		cell = findCell(row, col, genMax - 1);
+
+		if (mapCell(symImage(cell, sym), TRUE) !=
+			symImage(mapCell(cell, TRUE), sym))
+		{
+			return FALSE;
+		}
+
+		cell = findCell(row, col, 0);
+
+		if (mapCell(symImage(cell, sym), FALSE) !=
+			symImage(mapCell(cell, FALSE), sym))
+		{
+			return FALSE;
+		}
+	}
+
+	/*
+	 * Check the states, the flags, and the loops of the cells.
+	 */
+	for (gen = 0; gen < genMax; gen++)
+		for (row = 1; row <= rowMax; row++)
+			for (col = 1; col <= colMax; col++)
+	{
+		cell = findCell(row, col, gen);
+		image = symImage(cell, sym);
+
+		if ((cell->state != image->state) ||
+			((cell->flags ^ image->flags) & (FROZENCELL | CHOOSECELL)))
+		{
+			return FALSE;
+		}
+
+		if ((cellLoop(cell) >= 0) &&
+			!inLoop(image, symImage(cellTable + cellLoop(cell), sym)))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
+/*
+ * Return whether the second cell is in the loop of the first one.
+ */
+static Bool
+inLoop(const Cell * const cell, const Cell * const other)
+{
+	int	off;
+
+	if (cellLoop(cell) < 0)
+		return FALSE;
+
+	for (off = cellLoop(cell); off != cellOffset(cell); off = loopTable[off])
+	{
+		if (cellTable + off == other)
+			return TRUE;
+	}
+
+	return (cell == other);
+}
+
+
+/*
+ * Return the image of a cell under a symmetry, in the same generation.
+ */
+static Cell *
+symImage(const Cell * const cell, const int sym)
+{
+	int	row;
+	int	col;
+
+	row = cellRow(cell);
+	col = cellCol(cell);
+	symCoords(sym, &row, &col);
+
+	return findCell(row, col, cellGen(cell));
+}
+
+
+/*
+ * Map a row and column by a symmetry of the grid.  The first three are
+ * the reflections about the middle row and column and the rotation by a
+ * half turn, and the others only exist when the grid is square.
+ */
+static void
+symCoords(const int sym, int * row, int * col)
+{
+	int	nRow;
+	int	nCol;
+
+	nRow = rowMax + 1 - *row;
+	nCol = colMax + 1 - *col;
+
+	switch (sym)
+	{
+		case 1:		/* reflect about the middle row */
+			*row = nRow;
+			break;
+
+		case 2:		/* reflect about the middle column */
+			*col = nCol;
+			break;
+
+		case 3:		/* rotate a half turn */
+			*row = nRow;
+			*col = nCol;
+			break;
+
+		case 4:		/* reflect about the backward diagonal */
+			nRow = *col;
+			*col = *row;
+			*row = nRow;
+			break;
+
+		case 5:		/* reflect about the forward diagonal */
+			*row = nCol;
+			*col = nRow;
+			break;
+
+		case 6:		/* rotate a quarter turn */
+			*row = *col;
+			*col = nRow;
+			break;
+
+		case 7:		/* rotate three quarter turns */
+			*col = *row;
+			*row = nCol;
+			break;
+	}
+}
+
+/* END CODE */
@@ -0,0 +1,573 @@
+#include <limits.h>
+#include <stdlib.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "learn.h"
+#include "heatmap.h"
+#include "trace.h"
+
+/*
+ * Learning from conflicts.
+ * Every cell which is set records the reason for its setting.  When a
+ * setting fails, the cells set since the current choice are followed back
+ * through their reasons until a single one of them explains the conflict
+ * together with cells set before the choice.  Those cells can never all
+ * have their current states at once, which is remembered as a learned
+ * clause.  The search then clears every choice made after the deepest of
+ * the earlier cells, and the clause forces the single cell to its other
+ * state.  Choices which are already trying their other state are never
+ * cleared, so that no part of the search is repeated and objects which
+ * were already found are not found again.
+ *
+ * The learned clauses are kept in a ring of learnLimit entries, so that
+ * the newest clauses replace the oldest ones.  Each clause watches two of
+ * its cells which are not yet set to their states in the clause.  When a
+ * watched cell is set to the state, another cell is looked for to watch.
+ * If there is none, then the last cell is forced to the other state, or
+ * the clause fails if that cell is already set to its state too.
+ */
+
+#define	CLAUSE_LITS	16	/* most cells kept in a learned clause */
+
+/*
+ * One learned clause.  Each literal is the offset of a cell times two
+ * plus its state, and the clause forbids all of them at once.  The first
+ * two literals are the watched ones.  The clauses watching a literal are
+ * kept in a doubly linked list, where each link is the number of a clause
+ * times two plus which of its two watched literals is meant, or -1.
+ */
+typedef struct
+{
+	int	count;		/* number of literals, or 0 if unused */
+	int	next[2];	/* next link watching the same literal */
+	int	prev[2];	/* previous link, or -1 at the head */
+	int	lits[CLAUSE_LITS];	/* the literals */
+} Clause;
+
+#define	litCell(lit)	(cellTable + ((lit) >> 1))
+#define	litState(lit)	((State) ((lit) & 1))
+#define	litTrue(lit)	(litCell(lit)->state == litState(lit))
+
+#define	REASON_MASK	((1 << REASON_BITS) - 1)
+#define	isChoice(cell)	((reasonTable[cellOffset(cell)] & REASON_MASK) == \
+				REASON_CHOICE)
+
+static SEARCH_LOCAL Clause *	clauses;	/* the ring of learned clauses */
+static SEARCH_LOCAL int *	watchHead;	/* first clause watching each literal */
+static SEARCH_LOCAL int *	seenTable;	/* stamp of the conflict which saw each cell */
+static SEARCH_LOCAL int	seenStamp;	/* stamp for the current conflict */
+static SEARCH_LOCAL int	reasonSlot;	/* clause currently forcing cells */
+static SEARCH_LOCAL int	conflictKind;	/* kind of reason for the last conflict */
+static SEARCH_LOCAL const Cell *	conflictCell;	/* cell which could not be set */
+static SEARCH_LOCAL const Cell *	conflictSite;	/* cell giving the conflicting reason */
+static SEARCH_LOCAL int	conflictSlot;	/* clause giving the conflicting reason */
+static SEARCH_LOCAL int	levelPos;	/* position of the current choice */
+static SEARCH_LOCAL int	lowPos;		/* position of the deepest earlier cell */
+static SEARCH_LOCAL int	lowIndex;	/* index of that cell in the clause */
+static SEARCH_LOCAL int	litCount;	/* number of literals in the clause */
+static SEARCH_LOCAL int	lits[CLAUSE_LITS];	/* literals of the clause being learned */
+
+static int markCell(const Cell * const cell, const int pos);
+static int markReason(const int kind, const int value, const int pos);
+static void watch(const int slot, const int which);
+static void unwatch(const int slot, const int which);
+static void addClause(const int * const lits, const int count);
+
+
+/*
+ * Allocate the tables used for learning.
+ * This must be called once the cell table has been allocated.
+ */
+void
+learnInit(void)
+{
+	int	count;
+	int	off;
+
+	count = genStride * genMax;
+
+	free(reasonTable);
+	free(trailTable);
+	free(seenTable);
+	free(watchHead);
+	free(clauses);
+
+	reasonTable = (int *) malloc(sizeof(int) * count);
+	trailTable = (int *) malloc(sizeof(int) * count);
+	seenTable = (int *) calloc(count, sizeof(int));
+	watchHead = (int *) malloc(sizeof(int) * count * 2);
+	clauses = (Clause *) calloc(learnLimit, sizeof(Clause));
+
+	if ((reasonTable == NULL) || (trailTable == NULL) ||
+		(seenTable == NULL) || (watchHead == NULL) || (clauses == NULL))
+	{
+		fatal("Cannot allocate learning tables");
+	}
+
+	for (off = 0; off < count; off++)
+	{
+		reasonTable[off] = REASON_CHOICE;
+		trailTable[off] = -1;
+		watchHead[off * 2] = -1;
+		watchHead[off * 2 + 1] = -1;
+	}
+
+	seenStamp = 0;
+	learnCount = 0;
+	jumpCount = 0;
+}
+
+
+/*
+ * Free the tables used for learning.
+ */
+void
+learnFree(void)
+{
+	free(reasonTable);
+	free(trailTable);
+	free(seenTable);
+	free(watchHead);
+	free(clauses);
+
+	reasonTable = NULL;
+	trailTable = NULL;
+	seenTable = NULL;
+	watchHead = NULL;
+	clauses = NULL;
+}
+
+
+/*
+ * Record the reason for a cell which has just been added to the
+ * setting table.
+ */
+void
+learnSet(const Cell * const cell)
+{
+	int	value;
+
+	if (reasonKind == REASON_CLAUSE)
+		value = reasonSlot;
+	else if (reasonKind == REASON_CHOICE)
+		value = 0;
+	else
+		value = cellOffset(reasonCell);
+
+	reasonTable[cellOffset(cell)] = (value << REASON_BITS) | reasonKind;
+	trailTable[cellOffset(cell)] = newSet - setTable - 1;
+}
+
+
+/*
+ * Remember why a cell could not be set, for use by learnConflict.
+ * The kind is the current reason for setting cells, or REASON_LIMIT if
+ * a limit was broken.  Always returns ERROR.
+ */
+Status
+learnError(const int kind, const Cell * const cell)
+{
+	if (heatCounting)
+		heatConflict(cell);
+
+	conflictKind = kind;
+	conflictCell = cell;
+	conflictSite = reasonCell;
+	conflictSlot = reasonSlot;
+
+	return ERROR;
+}
+
+
+/*
+ * Check the learned clauses watching the state of a newly examined cell.
+ * Cells are forced when only one unknown cell remains in a clause.
+ * Returns ERROR if a clause fails.
+ */
+Status
+learnPropagate(const Cell * const cell)
+{
+	Clause *	clause;
+	Cell *		other;
+	int		link;
+	int		next;
+	int		lit;
+	int		slot;
+	int		which;
+	int		tmp;
+	int		i;
+
+	lit = cellOffset(cell) * 2 + cell->state;
+
+	for (link = watchHead[lit]; link >= 0; link = next)
+	{
+		slot = link >> 1;
+		which = link & 1;
+		clause = &clauses[slot];
+		next = clause->next[which];
+
+		/*
+		 * Look for another literal to watch.
+		 */
+		for (i = 2; i < clause->count; i++)
+		{
+			if (!litTrue(clause->lits[i]))
+				break;
+		}
+
+		if (i < clause->count)
+		{
+			unwatch(slot, which);
+			tmp = clause->lits[i];
+			clause->lits[i] = lit;
+			clause->lits[which] = tmp;
+			watch(slot, which);
+
+			continue;
+		}
+
+		tmp = clause->lits[1 - which];
+		other = litCell(tmp);
+
+		if (other->state == UNK)
+		{
+			reasonKind = REASON_CLAUSE;
+			reasonSlot = slot;
+
+			if (setCell(other, 1 - litState(tmp), FALSE) != OK)
+			{
+				reasonKind = REASON_SITE;
+
+				return ERROR;
+			}
+
+			/*
+			 * Clauses are not dumped, so the cell is kept in
+			 * dump files as if it had been chosen.
+			 */
+			other->flags |= CHOSENCELL;
+
+			reasonKind = REASON_SITE;
+		}
+		else if (other->state == litState(tmp))
+		{
+			reasonSlot = slot;
+			TRACE(TRACE_CONFLICT, other, 1 - other->state, FALSE);
+
+			return learnError(REASON_CLAUSE, other);
+		}
+	}
+
+	return OK;
+}
+
+
+/*
+ * Analyse the last conflict and learn a clause from it.  The cells set
+ * since the current choice are replaced by the cells which forced them,
+ * in the reverse order of their setting, until only one of them is left.
+ * The clause is then that cell and the earlier cells which were reached.
+ * Returns the position in the setting table to clear back to, after which
+ * the remaining cell is forced to its other state by the clause, and
+ * returns that cell and state.  This skips every choice made after the
+ * deepest of the earlier cells, since none of them can help.  Returns NULL
+ * if the search should just back up normally instead, which is the case
+ * for conflicts from the limits of generation 0, and when the current
+ * choice is already trying its other state.
+ */
+Cell **
+learnConflict(Cell ** const cellPtr, State * const statePtr)
+{
+	Cell **		set;
+	Cell **		mark;
+	Cell **		choice;
+	const Cell *	cell;
+	int		kind;
+	int		pending;
+	int		reason;
+	int		off;
+	int		tmp;
+
+	kind = conflictKind;
+	conflictKind = REASON_CHOICE;
+	reasonKind = REASON_CHOICE;
+
+	if ((kind == REASON_CHOICE) || (kind == REASON_LIMIT))
+		return NULL;
+
+	/*
+	 * Find the current choice.
+	 */
+	for (choice = newSet - 1; choice >= baseSet; choice--)
+	{
+		if (isChoice(*choice))
+			break;
+	}
+
+	if ((choice < baseSet) || !((*choice)->flags & FREECELL))
+		return NULL;
+
+	if (++seenStamp == INT_MAX)
+	{
+		for (off = 0; off < genStride * genMax; off++)
+			seenTable[off] = 0;
+
+		seenStamp = 1;
+	}
+
+	levelPos = choice - setTable;
+	lowPos = -1;
+	litCount = 1;
+
+	pending = markCell(conflictCell, INT_MAX);
+
+	if (kind == REASON_CLAUSE)
+		pending += markReason(kind, conflictSlot, INT_MAX);
+	else
+		pending += markReason(kind, cellOffset(conflictSite), INT_MAX);
+
+	for (set = newSet; ; )
+	{
+		cell = *--set;
+		off = cellOffset(cell);
+
+		if (seenTable[off] != seenStamp)
+			continue;
+
+		if (--pending == 0)
+			break;
+
+		reason = reasonTable[off];
+		pending += markReason(reason & REASON_MASK, reason >> REASON_BITS,
+			set - setTable);
+	}
+
+	*cellPtr = (Cell *) cell;
+	*statePtr = 1 - cell->state;
+	lits[0] = off * 2 + cell->state;
+
+	/*
+	 * Clear back to the first choice after the deepest earlier cell,
+	 * but never past a choice which is trying its other state.
+	 */
+	mark = setTable + lowPos + 1;
+
+	if (mark < baseSet)
+		mark = baseSet;
+
+	for (set = choice - 1; set >= mark; set--)
+	{
+		if (isChoice(*set) && !((*set)->flags & FREECELL))
+		{
+			mark = set + 1;
+			break;
+		}
+	}
+
+	while (!isChoice(*mark))
+		mark++;
+
+	/*
+	 * Keep the clause if it is short enough, watching the remaining cell
+	 * and the deepest earlier cell.  The remaining cell is then forced by
+	 * the clause, and otherwise it is treated as a choice.
+	 */
+	if ((litCount >= 2) && (litCount <= CLAUSE_LITS))
+	{
+		tmp = lits[1];
+		lits[1] = lits[lowIndex];
+		lits[lowIndex] = tmp;
+		reasonSlot = learnCount % learnLimit;
+		addClause(lits, litCount);
+		reasonKind = REASON_CLAUSE;
+	}
+
+	return mark;
+}
+
+
+/*
+ * Mark a cell as part of the current conflict if it was set before the
+ * specified position in the setting table.  A cell of a loop is marked as
+ * the cell standing for the loop, which is the one in the setting table.  Cells outside the search
+ * area are never set, and are ignored.  Cells set before the current
+ * choice are added to the clause being learned instead of being examined
+ * further.  Returns 1 if a cell of the current choice is newly marked,
+ * and 0 otherwise.
+ */
+static int
+markCell(const Cell * const cell, const int pos)
+{
+	int	off;
+	int	trail;
+
+	off = varTable[cellOffset(cell)];
+	trail = trailTable[off];
+
+	if ((cell->state == UNK) || (trail < 0) || (trail >= pos) ||
+		(seenTable[off] == seenStamp))
+	{
+		return 0;
+	}
+
+	seenTable[off] = seenStamp;
+
+	if (trail >= levelPos)
+		return 1;
+
+	if (trail > lowPos)
+	{
+		lowPos = trail;
+		lowIndex = litCount;
+	}
+
+	if (litCount < CLAUSE_LITS)
+		lits[litCount] = off * 2 + cell->state;
+
+	litCount++;
+
+	return 0;
+}
+
+
+/*
+ * Mark the cells of a reason which were set before the specified
+ * position in the setting table.  Returns the number of newly marked cells.
+ */
+static int
+markReason(const int kind, const int value, const int pos)
+{
+	const Clause *	clause;
+	const Cell *	cell;
+	const Cell *	past;
+	int		count;
+	int		i;
+
+	cell = cellTable + value;
+	count = 0;
+
+	switch (kind)
+	{
+		case REASON_SITE:
+			/*
+			 * The cell and the cells around its past.
+			 */
+			past = cellPast(cell);
+			count += markCell(cell, pos);
+
+			for (i = 0; i < 9; i++)
+			{
+				count += markCell(past + (i / 3 - 1) * colStride +
+					i % 3 - 1, pos);
+			}
+
+			break;
+
+		case REASON_CLAUSE:
+			clause = &clauses[value];
+
+			for (i = 0; i < clause->count; i++)
+				count += markCell(litCell(clause->lits[i]), pos);
+
+			break;
+	}
+
+	return count;
+}
+
+
+/*
+ * Add a clause to the head of the list of clauses watching one of its
+ * first two literals.
+ */
+static void
+watch(const int slot, const int which)
+{
+	Clause *	clause;
+	int		head;
+
+	clause = &clauses[slot];
+	head = watchHead[clause->lits[which]];
+	clause->prev[which] = -1;
+	clause->next[which] = head;
+
+	if (head >= 0)
+		clauses[head >> 1].prev[head & 1] = slot * 2 + which;
+
+	watchHead[clause->lits[which]] = slot * 2 + which;
+}
+
+
+/*
+ * Remove a clause from the list of clauses watching one of its first
+ * two literals.
+ */
+static void
+unwatch(const int slot, const int which)
+{
+	Clause *	clause;
+	int		next;
+	int		prev;
+
+	clause = &clauses[slot];
+	next = clause->next[which];
+	prev = clause->prev[which];
+
+	if (prev >= 0)
+		clauses[prev >> 1].next[prev & 1] = next;
+	else
+		watchHead[clause->lits[which]] = next;
+
+	if (next >= 0)
+		clauses[next >> 1].prev[next & 1] = prev;
+}
+
+
+/*
+ * Add a learned clause to the ring, replacing the oldest one if the
+ * ring is full.  The literals are in the reverse order of setting, so
+ * the first two are the ones most likely to be cleared by backing up,
+ * and are watched.  Cells still forced by a replaced clause are then
+ * treated as chosen, which is always safe.
+ */
+static void
+addClause(const int * const lits, const int count)
+{
+	Clause *	clause;
+	int		slot;
+	int		lit;
+	int		i;
+
+	slot = learnCount % learnLimit;
+	clause = &clauses[slot];
+
+	if (clause->count)
+	{
+		unwatch(slot, 0);
+		unwatch(slot, 1);
+
+		for (i = 0; i < clause->count; i++)
+		{
+			lit = clause->lits[i];
+
+			if (reasonTable[lit >> 1] ==
+				((slot << REASON_BITS) | REASON_CLAUSE))
+			{
+				reasonTable[lit >> 1] = REASON_CHOICE;
+			}
+		}
+	}
+
+	clause->count = count;
+
+	for (i = 0; i < count; i++)
+		clause->lits[i] = lits[i];
+
+	watch(slot, 0);
+	watch(slot, 1);
+
+	learnCount++;
+}
+
+/* END CODE */
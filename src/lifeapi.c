@@ -0,0 +1,424 @@
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "lifeapi.h"
+#include "leader.h"
+#include "trace.h"
+
+/*
+ * Searches run by a program.
+ * All of the state of a search is kept separately by each thread, so
+ * each search is given a thread of its own which does all of the work
+ * for it.  The calls below pass requests to that thread and wait for
+ * them to be done, so that they look like ordinary calls to the caller.
+ * The routine for objects which are found is called on the thread of
+ * the search, which is the only place where the cells can be examined.
+ * Errors which are fatal to the command line program, such as running
+ * out of memory, still exit the whole process.
+ */
+
+/*
+ * Requests for the thread of a search.
+ */
+#define	REQ_NONE	0	/* no request is waiting */
+#define	REQ_CONFIGURE	1	/* set the options and set up the cells */
+#define	REQ_STEP	2	/* search for the next object */
+#define	REQ_QUIT	3	/* free the search and end the thread */
+
+
+struct LifeSearch
+{
+	pthread_t	thread;		/* thread which runs the search */
+	pthread_mutex_t	lock;		/* lock for the request */
+	pthread_cond_t	cond;		/* signalled when the request changes */
+	int		request;	/* request waiting to be done */
+	int		argc;		/* arguments for configuring */
+	char **		argv;
+	Status		status;		/* result of the last request */
+	Bool		configured;	/* search has been set up */
+	Bool		done;		/* search has no more objects */
+	LifeFound	found;		/* routine called for each object */
+	void *		arg;		/* argument for that routine */
+	volatile sig_atomic_t *	dumpFlag;	/* flag of the thread for dumping */
+	volatile sig_atomic_t *	cancelFlag;	/* flag of the thread for stopping */
+	long		conflicts;	/* conflicts when the last step ended */
+	char		message[80];	/* reason for the last error */
+};
+
+
+static void *	lifeThread(void *);
+static Status	lifeRequest(LifeSearch *, int);
+static void	doConfigure(LifeSearch *);
+static void	doStep(LifeSearch *);
+
+
+/*
+ * Create a new search and the thread which runs it.
+ * The routine is called with the search and the argument for each
+ * object found.  It can be NULL, in which case the objects are written
+ * to the output file given by -o if there is one.
+ * Returns NULL if the search cannot be created.
+ */
+LifeSearch *
+lifeCreate(LifeFound found, void * arg)
+{
+	LifeSearch *	life;
+	sigset_t	set;
+	sigset_t	oldSet;
+	int		err;
+
+	life = (LifeSearch *) calloc(1, sizeof(LifeSearch));
+
+	if (life == NULL)
+		return NULL;
+
+	life->found = found;
+	life->arg = arg;
+	life->request = REQ_NONE;
+
+	pthread_mutex_init(&life->lock, NULL);
+	pthread_cond_init(&life->cond, NULL);
+
+	/*
+	 * The signals for dumping and viewing belong to the command line
+	 * program, so the thread is started with them blocked.
+	 */
+	sigemptyset(&set);
+	sigaddset(&set, SIGUSR1);
+	sigaddset(&set, SIGUSR2);
+	pthread_sigmask(SIG_BLOCK, &set, &oldSet);
+
+	err = pthread_create(&life->thread, NULL, lifeThread, life);
+
+	pthread_sigmask(SIG_SETMASK, &oldSet, NULL);
+
+	if (err)
+	{
+		pthread_cond_destroy(&life->cond);
+		pthread_mutex_destroy(&life->lock);
+		free(life);
+
+		return NULL;
+	}
+
+	return life;
+}
+
+
+/*
+ * Configure a search from arguments like those of the command line,
+ * without the program name.  This can only be done once for a search.
+ * Options which need the terminal or more processes are not allowed.
+ * Dumps are only written when asked for by lifeDump.
+ * Returns OK on success, NOT_EXIST if the initial object is inconsistent
+ * so that there can be no objects, or ERROR with the reason left for
+ * lifeError.
+ */
+Status
+lifeConfigure(LifeSearch * life, int argc, char ** argv)
+{
+	life->argc = argc;
+	life->argv = argv;
+
+	return lifeRequest(life, REQ_CONFIGURE);
+}
+
+
+/*
+ * Search for the next object, calling the routine for it if it is found.
+ * Returns FOUND if an object was found, NOT_EXIST if there are no more
+ * objects, or ERROR if the search was not configured or was cancelled.
+ */
+Status
+lifeStep(LifeSearch * life)
+{
+	return lifeRequest(life, REQ_STEP);
+}
+
+
+/*
+ * Return the state of a cell of an object which has been found.
+ * This can only be called from the routine for found objects, since
+ * the cells belong to the thread of the search.  Returns UNK for cells
+ * outside of the search or when called from any other thread.
+ */
+State
+lifeCell(const LifeSearch * life, int row, int col, int gen)
+{
+	if (!pthread_equal(pthread_self(), life->thread) ||
+		!life->configured)
+	{
+		return UNK;
+	}
+
+	if ((row < 1) || (row > rowMax) || (col < 1) || (col > colMax) ||
+		(gen < 0) || (gen >= genMax))
+	{
+		return UNK;
+	}
+
+	return findCell(row, col, gen)->state;
+}
+
+
+/*
+ * Ask a search to dump its state to its dump file, which is done by the
+ * search itself before it chooses its next cell.  This can be called
+ * from any thread while the search is running.  Nothing is done if no
+ * dump file was given when the search was configured.
+ */
+void
+lifeDump(LifeSearch * life)
+{
+	if (life->dumpFlag)
+		*life->dumpFlag = TRUE;
+}
+
+
+/*
+ * Stop a search which is running, which then returns ERROR from lifeStep
+ * as soon as it next chooses a cell, and finds nothing more.  This can be
+ * called from any thread once the search has been configured.
+ */
+void
+lifeCancel(LifeSearch * life)
+{
+	if (life->cancelFlag)
+		*life->cancelFlag = TRUE;
+}
+
+
+/*
+ * Return the number of conflicts the search had when its last step ended.
+ */
+long
+lifeConflicts(const LifeSearch * life)
+{
+	return life->conflicts;
+}
+
+
+/*
+ * Return the reason for the last error of a search.
+ */
+const char *
+lifeError(const LifeSearch * life)
+{
+	return life->message;
+}
+
+
+/*
+ * Destroy a search, writing its trace if it was traced with -D, and
+ * freeing everything which belongs to it.
+ */
+void
+lifeDestroy(LifeSearch * life)
+{
+	lifeRequest(life, REQ_QUIT);
+	pthread_join(life->thread, NULL);
+
+	pthread_cond_destroy(&life->cond);
+	pthread_mutex_destroy(&life->lock);
+	free(life);
+}
+
+
+/*
+ * Give a request to the thread of a search and wait for it to be done.
+ * Returns the status of the request.
+ */
+static Status
+lifeRequest(LifeSearch * life, int request)
+{
+	Status	status;
+
+	pthread_mutex_lock(&life->lock);
+
+	life->request = request;
+	pthread_cond_broadcast(&life->cond);
+
+	while (life->request != REQ_NONE)
+		pthread_cond_wait(&life->cond, &life->lock);
+
+	status = life->status;
+
+	pthread_mutex_unlock(&life->lock);
+
+	return status;
+}
+
+
+/*
+ * The thread which runs a search.
+ * It waits for each request, does it, and says when it is done.
+ */
+static void *
+lifeThread(void * arg)
+{
+	LifeSearch *	life = (LifeSearch *) arg;
+	int		request;
+
+	for (;;)
+	{
+		pthread_mutex_lock(&life->lock);
+
+		while (life->request == REQ_NONE)
+			pthread_cond_wait(&life->cond, &life->lock);
+
+		request = life->request;
+
+		pthread_mutex_unlock(&life->lock);
+
+		life->status = OK;
+
+		if (request == REQ_CONFIGURE)
+			doConfigure(life);
+		else if (request == REQ_STEP)
+			doStep(life);
+		else
+		{
+			traceEnd();
+			freeCells();
+		}
+
+		pthread_mutex_lock(&life->lock);
+
+		life->request = REQ_NONE;
+		pthread_cond_broadcast(&life->cond);
+
+		pthread_mutex_unlock(&life->lock);
+
+		if (request == REQ_QUIT)
+			return NULL;
+	}
+}
+
+
+/*
+ * Set the options of the search and set up its cells.
+ */
+static void
+doConfigure(LifeSearch * life)
+{
+	const char *	msg;
+	Status		status;
+
+	life->status = ERROR;
+
+	if (life->configured)
+	{
+		strcpy(life->message, "Search is already configured");
+
+		return;
+	}
+
+	msg = setOptions(life->argc, life->argv);
+
+	if (msg && (*msg == '\0'))
+		msg = "Bad arguments";
+
+	if ((msg == NULL) && (workers > 1))
+		msg = "Parallel search is not allowed";
+
+	if ((msg == NULL) && forkDumps)
+		msg = "Forked dumps are not allowed";
+
+	if (msg)
+	{
+		strncpy(life->message, msg, sizeof(life->message) - 1);
+
+		return;
+	}
+
+	status = setupSearch();
+
+	if (status == NOT_EXIST)
+	{
+		strcpy(life->message, "Initial object is inconsistent");
+		life->status = NOT_EXIST;
+
+		return;
+	}
+
+	if (status != OK)
+	{
+		strcpy(life->message, "Cannot set up the search");
+
+		return;
+	}
+
+	if (dumpFile)
+		life->dumpFlag = &dumpFlag;
+
+	life->cancelFlag = &cancelFlag;
+
+	if (traceFile)
+		traceStart();
+
+	leaderStart();
+	inited = TRUE;
+	life->configured = TRUE;
+	life->status = OK;
+}
+
+
+/*
+ * Search for the next object.
+ * Objects with sub-periods are skipped unless all objects were asked for,
+ * and so are objects already found if duplicates are being suppressed.
+ * Objects are written to the output file if there is one, unless there is
+ * a routine for found objects, which is then left to do that.
+ */
+static void
+doStep(LifeSearch * life)
+{
+	if (!life->configured)
+	{
+		strcpy(life->message, "Search is not configured");
+		life->status = ERROR;
+
+		return;
+	}
+
+	life->status = NOT_EXIST;
+
+	if (life->done)
+		return;
+
+	do
+		curStatus = search(TRUE);
+	while ((curStatus == FOUND) && !acceptObject());
+
+	life->conflicts = stepConfl;
+
+	if (cancelFlag)
+	{
+		strcpy(life->message, "Search was cancelled");
+		life->status = ERROR;
+		life->done = TRUE;
+
+		return;
+	}
+
+	if (curStatus != FOUND)
+	{
+		life->done = TRUE;
+
+		return;
+	}
+
+	if (life->found)
+		life->found(life, life->arg);
+	else if (outputFile)
+		writeGen(outputFile, TRUE);
+
+	curStatus = OK;
+	life->status = FOUND;
+}
+
+/* END CODE */
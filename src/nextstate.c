@@ -1,9 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "lifesrc.h"
 #include "state.h"
 #include "nextstate.h"
 
-static State unkRules[9 * ((int) UNK + 1)] = { UNK };
+static SEARCH_LOCAL State unkRules[9 * ((int) UNK + 1)] = { UNK };
 
 void initNextState(const State * bornRules, const State * liveRules)
 {
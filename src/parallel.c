@@ -0,0 +1,433 @@
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "setstate.h"
+#include "parallel.h"
+#include "unique.h"
+
+/*
+ * One cell of a stolen branch, and the state it is to be set to.
+ */
+typedef struct
+{
+	short	row;
+	short	col;
+	short	gen;
+	short	state;
+} JobCell;
+
+/*
+ * Mailbox in which a busy worker leaves a branch for an idle worker.
+ */
+typedef struct
+{
+	Bool	waiting;	/* owner is waiting for work */
+	Bool	filled;		/* a branch has been left here */
+	int	count;		/* number of cells in the branch */
+	JobCell	cells[];	/* cells to set to reach the branch */
+} Mailbox;
+
+/*
+ * Data shared between all of the worker processes.
+ */
+typedef struct
+{
+	pthread_mutex_t	lock;	/* protects everything here */
+	pthread_cond_t	cond;	/* signalled when work or completion arrives */
+	volatile int	alert;	/* busy workers should look at the pool */
+	int	workers;	/* number of worker processes */
+	int	idle;		/* number of workers waiting for work */
+	Bool	done;		/* search is finished or cancelled */
+	long	found;		/* number of objects found */
+	long	steals;		/* number of branches handed out */
+} Pool;
+
+static SEARCH_LOCAL Pool *	pool;		/* the shared pool */
+static SEARCH_LOCAL char *	boxes;		/* the shared mailboxes */
+static SEARCH_LOCAL size_t	boxSize;	/* size of each mailbox */
+static SEARCH_LOCAL int	worker;		/* index of this worker */
+static SEARCH_LOCAL Cell **	rootSet;	/* base of the search common to all workers */
+
+static Mailbox * getBox(const int index);
+static Bool takeWork(void);
+static Bool isComplete(void);
+static void runWorker(const int index);
+static void foundObject(void);
+
+
+/*
+ * Return the mailbox of a worker.
+ */
+static Mailbox *
+getBox(const int index)
+{
+	return (Mailbox *) (boxes + boxSize * index);
+}
+
+
+/*
+ * Search for objects using the specified number of worker processes.
+ * Each worker is forked from the current state, so it owns a private
+ * copy of the cells and of the setting table.  The first worker starts
+ * on the whole search, and the others steal unexplored branches from it
+ * and from each other as they run out of work.  Objects are reported by
+ * the workers as they are found, and so are not in the serial order.
+ * Returns the number of objects which were found.
+ */
+long
+parallelSearch(const int count)
+{
+	pthread_mutexattr_t	mutexAttr;
+	pthread_condattr_t	condAttr;
+	pid_t *	pids;
+	size_t	size;
+	long	found;
+	int	status;
+	int	i;
+
+	/*
+	 * A branch can never be longer than the number of settable cells.
+	 */
+	boxSize = sizeof(Mailbox) + sizeof(JobCell) * rowMax * colMax * genMax;
+	boxSize = (boxSize + 63) & ~((size_t) 63);
+	size = ((sizeof(Pool) + 63) & ~((size_t) 63)) + boxSize * count;
+
+	pool = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if (pool == MAP_FAILED)
+		fatal("Cannot allocate worker pool");
+
+	boxes = ((char *) pool) + ((sizeof(Pool) + 63) & ~((size_t) 63));
+
+	pthread_mutexattr_init(&mutexAttr);
+	pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+	pthread_mutex_init(&pool->lock, &mutexAttr);
+	pthread_mutexattr_destroy(&mutexAttr);
+
+	pthread_condattr_init(&condAttr);
+	pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+	pthread_cond_init(&pool->cond, &condAttr);
+	pthread_condattr_destroy(&condAttr);
+
+	/*
+	 * All workers except the first one start out by asking for work.
+	 */
+	pool->workers = count;
+
+	rootSet = baseSet;
+
+	pids = (pid_t *) malloc(sizeof(pid_t) * count);
+
+	if (pids == NULL)
+		fatal("Cannot allocate worker table");
+
+	uniqueShare();
+
+	fflush(stdout);
+	fflush(stderr);
+
+	for (i = 0; i < count; i++)
+	{
+		pids[i] = fork();
+
+		if (pids[i] < 0)
+			fatal("Cannot fork worker");
+
+		if (pids[i] == 0)
+			runWorker(i);
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		while ((waitpid(pids[i], &status, 0) < 0) && (errno == EINTR))
+			;
+	}
+
+	uniqueUnshare();
+
+	found = pool->found;
+
+	if (!quiet)
+		printf("%ld branches were handed out between %d workers\n",
+			pool->steals, count);
+
+	free(pids);
+	munmap(pool, size);
+	pool = NULL;
+
+	return found;
+}
+
+
+/*
+ * Main loop of a worker process.  Never returns.
+ */
+static void
+runWorker(const int index)
+{
+	worker = index;
+	stealFlag = &pool->alert;
+
+	if ((worker > 0) && !takeWork())
+		exit(0);
+
+	for (;;)
+	{
+		if (search(TRUE) == FOUND)
+		{
+			foundObject();
+
+			continue;
+		}
+
+		if (!takeWork())
+			break;
+
+		/*
+		 * A branch can already be a complete object, and the
+		 * search routine would back up over it without reporting it.
+		 */
+		if (isComplete())
+			foundObject();
+	}
+
+	exit(0);
+}
+
+
+/*
+ * Wait for another worker to hand over an unexplored branch, and then
+ * set up the cells to search it.  The cells of any previous branch are
+ * first cleared back to the common base of the search.
+ * Returns FALSE when there is no work left anywhere.
+ */
+static Bool
+takeWork(void)
+{
+	Mailbox *	box;
+	JobCell *	job;
+	Cell *		cell;
+	int		i;
+
+	box = getBox(worker);
+
+	for (;;)
+	{
+		/*
+		 * Clear all cells back to the common base of the search.
+		 * The backup call then resets the examining and search positions.
+		 */
+		while (newSet != rootSet)
+		{
+			cell = *--newSet;
+			setVar(cell, UNK);
+			cell->flags |= FREECELL;
+		}
+
+		baseSet = rootSet;
+		backup();
+
+		pthread_mutex_lock(&pool->lock);
+
+		box->waiting = TRUE;
+		pool->idle++;
+		pool->alert = TRUE;
+
+		if (pool->idle == pool->workers)
+		{
+			pool->done = TRUE;
+			pthread_cond_broadcast(&pool->cond);
+		}
+
+		while (!box->filled && !pool->done)
+			pthread_cond_wait(&pool->cond, &pool->lock);
+
+		if (!box->filled)
+		{
+			pthread_mutex_unlock(&pool->lock);
+
+			return FALSE;
+		}
+
+		box->filled = FALSE;
+		pthread_mutex_unlock(&pool->lock);
+
+		/*
+		 * Set all of the cells leading to the branch.
+		 * The cells are set as forced so that they are never backed up.
+		 */
+		for (i = 0; i < box->count; i++)
+		{
+			job = &box->cells[i];
+
+			if (proceed(findCell(job->row, job->col, job->gen),
+				job->state, FALSE) != OK)
+			{
+				break;
+			}
+		}
+
+		if (i == box->count)
+		{
+			baseSet = nextSet;
+
+			return TRUE;
+		}
+	}
+}
+
+
+/*
+ * Check whether all of the cells which can be chosen have been set.
+ */
+static Bool
+isComplete(void)
+{
+	const Cell *	cell;
+	int		row;
+	int		col;
+	int		gen;
+
+	for (gen = 0; gen < genMax; gen++)
+	{
+		for (row = 1; row <= rowMax; row++)
+		{
+			for (col = 1; col <= colMax; col++)
+			{
+				cell = findCell(row, col, gen);
+
+				if ((cell->state == UNK) &&
+					(cell->flags & CHOOSECELL))
+				{
+					return FALSE;
+				}
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+
+/*
+ * Give unexplored branches to the workers which are waiting for work.
+ * The branch given away is the shallowest free cell whose other state
+ * has not yet been tried, since that is likely to be the largest one.
+ * That cell is then marked as forced so that this worker does not try
+ * the other state itself.  If the search has been cancelled, then
+ * the worker just exits.
+ */
+void
+donateWork(void)
+{
+	Mailbox *	box;
+	Cell **		set;
+	Cell **		branch;
+	const Cell *	cell;
+	int		i;
+
+	pthread_mutex_lock(&pool->lock);
+
+	if (pool->done)
+	{
+		pthread_mutex_unlock(&pool->lock);
+		exit(0);
+	}
+
+	branch = baseSet;
+
+	for (i = 0; (i < pool->workers) && (pool->idle > 0); i++)
+	{
+		box = getBox(i);
+
+		if (!box->waiting || box->filled)
+			continue;
+
+		while ((branch < newSet) && !((*branch)->flags & FREECELL))
+			branch++;
+
+		if (branch == newSet)
+			break;
+
+		box->count = 0;
+
+		for (set = rootSet; set <= branch; set++)
+		{
+			cell = *set;
+			box->cells[box->count].row = cellRow(cell);
+			box->cells[box->count].col = cellCol(cell);
+			box->cells[box->count].gen = cellGen(cell);
+			box->cells[box->count].state = cell->state;
+			box->count++;
+		}
+
+		box->cells[box->count - 1].state = 1 - (*branch)->state;
+		(*branch)->flags &= ~FREECELL;
+
+		box->waiting = FALSE;
+		box->filled = TRUE;
+		pool->idle--;
+		pool->steals++;
+	}
+
+	pool->alert = (pool->idle > 0);
+	pthread_cond_broadcast(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+
+/*
+ * Report an object found by this worker.
+ * Objects with sub-periods are skipped unless all objects are wanted, and
+ * objects already found are skipped if duplicates are being suppressed.
+ * If only one object is wanted, then the whole search is cancelled.
+ */
+static void
+foundObject(void)
+{
+	long	found;
+
+	if (!acceptObject())
+		return;
+
+	pthread_mutex_lock(&pool->lock);
+
+	if (pool->done)
+	{
+		pthread_mutex_unlock(&pool->lock);
+		exit(0);
+	}
+
+	found = ++pool->found;
+
+	if (!quiet)
+	{
+		printGen(0);
+		ttyStatus("Object %ld found by worker %d (unordered).\n",
+			found, worker);
+	}
+
+	if (outputFile)
+		writeGen(outputFile, TRUE);
+
+	fflush(stdout);
+
+	if (!allObjects)
+	{
+		pool->done = TRUE;
+		pool->alert = TRUE;
+		pthread_cond_broadcast(&pool->cond);
+		pthread_mutex_unlock(&pool->lock);
+		exit(0);
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/* END CODE */
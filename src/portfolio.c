@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "lifeapi.h"
+#include "sectohms.h"
+#include "portfolio.h"
+
+/*
+ * Racing of search orders.
+ * The same search is run at once by a thread for each of several ways
+ * of ordering and choosing its cells, since the choice can make an
+ * enormous difference to how long a search takes.  The first one to
+ * find an object or to show that there are none wins, and the others are
+ * cancelled.  The numbers of conflicts reached by each one are reported,
+ * which shows which options to use for similar searches.
+ */
+
+/*
+ * Options added to the search for each entrant of the race.
+ */
+static const char * const optionTable[] =
+{
+	"", "-or", "-oc", "-of", "-ob", "-om", "-ow", "-og", "-fo", "-fg", "-od",
+	NULL
+};
+
+
+/*
+ * One entrant of the race.
+ */
+typedef struct
+{
+	const char *	options;	/* option for this entrant */
+	LifeSearch *	life;		/* its search */
+	pthread_t	thread;		/* thread which runs the search */
+	Status		status;		/* result of the search */
+	long		conflicts;	/* conflicts when the search ended */
+	Bool		running;	/* search can be cancelled */
+	char		message[80];	/* reason for an error */
+} Entrant;
+
+
+static char **		baseArgs;	/* options for all of the entrants */
+static int		baseCount;	/* number of those options */
+static Entrant *	entrants;	/* table of entrants */
+static int		entrantCount;	/* number of entrants */
+static Entrant *	winner;		/* entrant which won the race */
+static pthread_mutex_t	raceLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void *	runEntrant(void *);
+static void	foundObject(LifeSearch *, void *);
+static void	claimWin(Entrant *);
+
+
+/*
+ * Race the search given by the command line arguments using the orders
+ * in the table.  The -portfolio option itself is left out of the
+ * arguments given to the searches.
+ * Returns the exit status for the program.
+ */
+int
+runPortfolio(int argc, char ** argv)
+{
+	Entrant *	ent;
+	const char *	result;
+	time_t		start;
+	time_t		end;
+	char		buf[256];
+	int		i;
+
+	baseArgs = (char **) malloc(sizeof(char *) * (argc + 1));
+
+	for (entrantCount = 0; optionTable[entrantCount]; entrantCount++)
+		;
+
+	entrants = (Entrant *) calloc(entrantCount, sizeof(Entrant));
+
+	if ((baseArgs == NULL) || (entrants == NULL))
+		fatal("Cannot allocate portfolio");
+
+	for (i = 0; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-portfolio"))
+			baseArgs[baseCount++] = argv[i];
+	}
+
+	time(&start);
+
+	for (i = 0; i < entrantCount; i++)
+	{
+		ent = &entrants[i];
+		ent->options = optionTable[i];
+
+		if (pthread_create(&ent->thread, NULL, runEntrant, ent))
+			fatal("Cannot create portfolio thread");
+	}
+
+	for (i = 0; i < entrantCount; i++)
+		pthread_join(entrants[i].thread, NULL);
+
+	time(&end);
+	secToHMS(end - start, buf);
+
+	printf("Portfolio of %d orders completed in%s\n", entrantCount, buf);
+
+	for (i = 0; i < entrantCount; i++)
+	{
+		ent = &entrants[i];
+
+		if (ent == winner)
+			result = (ent->status == FOUND) ?
+				"won, found an object" : "won, no objects exist";
+		else if (ent->status == OK)
+			result = "not started";
+		else if (ent->message[0])
+			result = ent->message;
+		else
+			result = "lost";
+
+		printf("  %-8s %10ld conflicts  %s\n",
+			*ent->options ? ent->options : "default",
+			ent->conflicts, result);
+	}
+
+	if ((winner == NULL) || (winner->status != FOUND))
+	{
+		printf("No objects found.\n");
+
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/*
+ * The thread of an entrant, which configures and runs its search and
+ * then claims the race if it finished before the others.
+ */
+static void *
+runEntrant(void * arg)
+{
+	Entrant *	ent = (Entrant *) arg;
+	char **		args;
+	int		count;
+
+	args = (char **) malloc(sizeof(char *) * (baseCount + 1));
+
+	if (args == NULL)
+		fatal("Cannot allocate portfolio");
+
+	memcpy(args, baseArgs, sizeof(char *) * baseCount);
+	count = baseCount;
+
+	if (*ent->options)
+		args[count++] = (char *) ent->options;
+
+	ent->life = lifeCreate(foundObject, ent);
+
+	if (ent->life == NULL)
+		fatal("Cannot create search");
+
+	ent->status = lifeConfigure(ent->life, count, args);
+
+	/*
+	 * Only start the search if the race is not already over, and
+	 * mark it as running so that it is cancelled when it is.
+	 */
+	if (ent->status == OK)
+	{
+		pthread_mutex_lock(&raceLock);
+		ent->running = (winner == NULL);
+		pthread_mutex_unlock(&raceLock);
+
+		if (ent->running)
+			ent->status = lifeStep(ent->life);
+	}
+
+	if ((ent->status == FOUND) || (ent->status == NOT_EXIST))
+		claimWin(ent);
+	else if (ent->status != OK)
+	{
+		strncpy(ent->message, lifeError(ent->life),
+			sizeof(ent->message) - 1);
+	}
+
+	pthread_mutex_lock(&raceLock);
+	ent->running = FALSE;
+	pthread_mutex_unlock(&raceLock);
+
+	ent->conflicts = lifeConflicts(ent->life);
+	lifeDestroy(ent->life);
+	free(args);
+
+	return NULL;
+}
+
+
+/*
+ * Called on the thread of a search which has found an object.
+ * If it is the first one to finish, then it wins and its object is
+ * shown and written to the output file if there is one.
+ */
+static void
+foundObject(LifeSearch * life, void * arg)
+{
+	Entrant *	ent = (Entrant *) arg;
+
+	claimWin(ent);
+
+	if (winner != ent)
+		return;
+
+	if (!quiet)
+		printGen(0);
+
+	if (outputFile)
+		writeGen(outputFile, TRUE);
+
+	fflush(stdout);
+}
+
+
+/*
+ * Make an entrant the winner of the race if there is none yet, and then
+ * cancel all of the other searches which are running.
+ */
+static void
+claimWin(Entrant * ent)
+{
+	int	i;
+
+	pthread_mutex_lock(&raceLock);
+
+	if (winner == NULL)
+	{
+		winner = ent;
+
+		for (i = 0; i < entrantCount; i++)
+		{
+			if (entrants[i].running && (&entrants[i] != ent))
+				lifeCancel(entrants[i].life);
+		}
+	}
+
+	pthread_mutex_unlock(&raceLock);
+}
+
+/* END CODE */
@@ -48,9 +48,9 @@ void printAsc(const int gen, const Bool augment)
                 /* cells with changed states between generations are marked bold */
                 if (changeFlag) idx += 2;
                 /* inverse highlight the first searchable cell */
-                if (cell->index == 0) idx += 4;
+                if (cellIndex(cell) == 0) idx += 4;
                 /* dim all cells not in the searchlist */
-                if (cell->index < 0) idx += 8;
+                if (cellIndex(cell) < 0) idx += 8;
             }
 
             ttyPrintf("%s ", ascii[idx]);
@@ -6,7 +6,8 @@
 
 #define MAXCOLS_RLE 70
 
-static int buffer[ROW_MAX * COL_MAX] = {0};
+static SEARCH_LOCAL int * buffer;
+static SEARCH_LOCAL int bufferSize;
 
 char stateToString(const State state)
 {
@@ -124,6 +125,17 @@ void printRLE(const int gen, const char *rule)
 {
     const Cell *cell;
 
+    /* make the buffer large enough for the search */
+    if (bufferSize < (rowMax + 1) * colMax + 1)
+    {
+        free(buffer);
+        bufferSize = (rowMax + 1) * colMax + 1;
+        buffer = (int *) malloc(sizeof(int) * bufferSize);
+
+        if (buffer == NULL)
+            fatal("Cannot allocate RLE buffer");
+    }
+
     /* initialize buffer */
     for (int row = 1; row <= rowMax; row ++)
     {
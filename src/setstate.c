@@ -1,21 +1,109 @@
 #include "lifesrc.h"
 #include "state.h"
+#include "bitengine.h"
+#include "dynorder.h"
+
+/*
+ * Adjust the counts of the row and column of a cell in generation 0
+ * for a change of its state.  Setting a cell back to unknown undoes
+ * exactly what setting it did, so backing up restores the counts.
+ */
+static void countState(const Cell * const cell, const State oldState,
+    const State state)
+{
+    int off = cellOffset(cell);
+    int rowNum = off % colStride - CELL_PAD;
+    RowInfo * row = &rowInfo[rowNum];
+    ColInfo * col = &colInfo[off / colStride - CELL_PAD];
+
+    if (oldState == UNK)
+    {
+        if (state == UNK)
+            return;
+
+        row->setCount++;
+        col->setCount++;
+
+        if (col->setCount == rowMax)
+            fullColumns++;
+
+        if (state == ON)
+        {
+            row->onCount++;
+            col->onCount++;
+            col->sumPos += rowNum;
+            cellCount++;
+        }
+
+        return;
+    }
+
+    if (state != UNK)
+        return;
+
+    if (col->setCount == rowMax)
+        fullColumns--;
+
+    row->setCount--;
+    col->setCount--;
+
+    if (oldState == ON)
+    {
+        row->onCount--;
+        col->onCount--;
+        col->sumPos -= rowNum;
+        cellCount--;
+    }
+
+    return;
+}
+
 
 void setState(Cell * const cell, const State state)
 {
     /* backup previous state */
-    int diffState = state - cell->state;
+    State oldState = cell->state;
+    int diffState = state - oldState;
+    /* keep the row and column counts of generation 0 up to date */
+    if (cellOffset(cell) < genStride)
+        countState(cell, oldState, state);
     /* set cell state */
     cell->state = state;
     /* correct the neighbor sum for cells touching this cell */
-    cell->cul->sumNear += diffState;
-    cell->cu->sumNear += diffState;
-    cell->cur->sumNear += diffState;
-    cell->cl->sumNear += diffState;
-    cell->cr->sumNear += diffState;
-    cell->cdl->sumNear += diffState;
-    cell->cd->sumNear += diffState;
-    cell->cdr->sumNear += diffState;
+    cellUL(cell)->sumNear += diffState;
+    cellU(cell)->sumNear += diffState;
+    cellUR(cell)->sumNear += diffState;
+    cellL(cell)->sumNear += diffState;
+    cellR(cell)->sumNear += diffState;
+    cellDL(cell)->sumNear += diffState;
+    cellD(cell)->sumNear += diffState;
+    cellDR(cell)->sumNear += diffState;
+    /* keep the bit masks of the bit engine up to date */
+    if (engine != ENGINE_CELL)
+        bitUpdate(cell, state);
+    /* keep the heap of the dynamic search order up to date */
+    if (orderDynamic)
+        dynUpdate(cell, oldState);
 
     return;
 }
+
+
+/*
+ * Set the state of a cell which stands for its loop, and of all of the
+ * other cells of the loop.  Each cell of the loop is set in its own place,
+ * so that the neighbor sums around all of them stay correct, but only the
+ * cell standing for the loop is kept in the setting table.
+ */
+void setVar(Cell * const cell, const State state)
+{
+    int off;
+
+    setState(cell, state);
+
+    if (!(cell->flags & LOOPCELL))
+        return;
+
+    for (off = cellLoop(cell); off != cellOffset(cell); off = loopTable[off])
+        setState(cellTable + off, state);
+}
@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "simulate.h"
+
+/*
+ * Checking of found objects by running them.
+ * An object is only known to work within the search area and under the
+ * assumptions of the search, so it is run forward on an unbounded plane
+ * for several of its periods using the current rules.  This finds its
+ * true period and how far it moves in each period, or else shows that it
+ * dies out, or grows or throws off debris.  The plane is kept as a box
+ * just large enough for the live cells, with each row of the box held as
+ * bit masks, and a whole word of cells is evolved at a time by adding the
+ * neighbors as bit slices.
+ */
+typedef	uint64_t	Bits;
+
+#define	WORD_BITS	64
+#define	SIM_PERIODS	4	/* periods of the search to run objects for */
+
+
+/*
+ * The live cells of a generation, kept as the rows of their bounding box.
+ */
+typedef struct
+{
+	long	top;		/* row of the top of the box on the plane */
+	long	left;		/* column of the left of the box on the plane */
+	int	rows;		/* number of rows of the box, zero if empty */
+	int	cols;		/* number of columns of the box */
+	int	words;		/* number of words in each row */
+	Bits *	bits;		/* cells of the box which are ON */
+} Plane;
+
+
+/*
+ * Add three bit slices, giving the sum and carry slices.
+ */
+#define	fullAdd(sum, carry, a, b, c) \
+	{ Bits t_ = (a) ^ (b); (sum) = t_ ^ (c); \
+	(carry) = ((a) & (b)) | (t_ & (c)); }
+
+
+static void	planeLoad(Plane *, const int);
+static void	planeStep(const Plane *, Plane *);
+static void	planeTrim(const Plane *, Plane *);
+static Bool	planeSame(const Plane *, const Plane *);
+static Bits	rowWord(const Bits *, const int, const int);
+static void	countNeighbors(Bits *, const Bits *, const Bits *, const Bits *);
+static Bits	countIs(const Bits *, const int);
+
+
+/*
+ * Run the object in a generation of the search forward and describe what
+ * it does.  It is run for a few times the number of generations of the
+ * search, so that objects which come back reflected after one period, as
+ * with the flipping options, are also recognized.
+ * Returns a description of the object, which is kept until the next call.
+ */
+const char *
+classifyObject(const int gen)
+{
+	static SEARCH_LOCAL char	desc[80];
+	Plane	first;
+	Plane	cur;
+	Plane	next;
+	int	maxRows;
+	int	maxCols;
+	int	limit;
+	int	t;
+
+	if (bornRules[0] == ON)
+		return "not run, since cells are born from nothing";
+
+	planeLoad(&first, gen);
+
+	if (first.rows == 0)
+	{
+		free(first.bits);
+
+		return "empty";
+	}
+
+	planeLoad(&cur, gen);
+
+	maxRows = cur.rows;
+	maxCols = cur.cols;
+	limit = SIM_PERIODS * genMax;
+
+	sprintf(desc, "no period within %d generations", limit);
+
+	for (t = 1; t <= limit; t++)
+	{
+		planeStep(&cur, &next);
+		free(cur.bits);
+		cur = next;
+
+		if (cur.rows == 0)
+		{
+			sprintf(desc, "dies out in %d generation%s",
+				t, (t == 1) ? "" : "s");
+
+			break;
+		}
+
+		if (planeSame(&cur, &first))
+		{
+			if ((cur.top != first.top) || (cur.left != first.left))
+				sprintf(desc, "spaceship period %d moving (%ld,%ld)",
+					t, cur.top - first.top,
+					cur.left - first.left);
+			else if (t == 1)
+				strcpy(desc, "still life");
+			else
+				sprintf(desc, "oscillator period %d", t);
+
+			break;
+		}
+
+		/*
+		 * An object which keeps needing a larger box than it did
+		 * during the first period of the search is growing or has
+		 * thrown off debris.
+		 */
+		if (t <= genMax)
+		{
+			if (cur.rows > maxRows)
+				maxRows = cur.rows;
+
+			if (cur.cols > maxCols)
+				maxCols = cur.cols;
+		}
+		else if ((t == limit) &&
+			((cur.rows > maxRows) || (cur.cols > maxCols)))
+		{
+			strcpy(desc, "grows or emits debris");
+		}
+	}
+
+	free(first.bits);
+	free(cur.bits);
+
+	return desc;
+}
+
+
+/*
+ * Load the cells of a generation of the search which are ON.
+ */
+static void
+planeLoad(Plane * plane, const int gen)
+{
+	Plane	whole;
+	int	row;
+	int	col;
+
+	whole.top = 1;
+	whole.left = 1;
+	whole.rows = rowMax;
+	whole.cols = colMax;
+	whole.words = (colMax + WORD_BITS - 1) / WORD_BITS;
+	whole.bits = (Bits *) calloc(whole.rows * whole.words, sizeof(Bits));
+
+	if (whole.bits == NULL)
+		fatal("Cannot allocate simulation");
+
+	for (row = 1; row <= rowMax; row++)
+	{
+		for (col = 1; col <= colMax; col++)
+		{
+			if (findCell(row, col, gen)->state != ON)
+				continue;
+
+			whole.bits[(row - 1) * whole.words + (col - 1) / WORD_BITS] |=
+				((Bits) 1) << ((col - 1) % WORD_BITS);
+		}
+	}
+
+	planeTrim(&whole, plane);
+	free(whole.bits);
+}
+
+
+/*
+ * Evolve a plane by one generation into another one.  The new box is
+ * one cell larger on every side, and is then trimmed to its live cells.
+ */
+static void
+planeStep(const Plane * src, Plane * dst)
+{
+	Plane		wide;
+	const Bits *	line;
+	Bits		above[3];
+	Bits		mid[3];
+	Bits		below[3];
+	Bits *		slices[3];
+	Bits		sum[4];
+	Bits		next;
+	int		row;
+	int		word;
+	int		pos;
+	int		i;
+	int		n;
+
+	wide.top = src->top - 1;
+	wide.left = src->left - 1;
+	wide.rows = src->rows + 2;
+	wide.cols = src->cols + 2;
+	wide.words = (wide.cols + WORD_BITS - 1) / WORD_BITS;
+	wide.bits = (Bits *) calloc(wide.rows * wide.words, sizeof(Bits));
+
+	if (wide.bits == NULL)
+		fatal("Cannot allocate simulation");
+
+	slices[0] = above;
+	slices[1] = mid;
+	slices[2] = below;
+
+	for (row = 0; row < wide.rows; row++)
+	{
+		for (word = 0; word < wide.words; word++)
+		{
+			/*
+			 * Get the words of the rows above, at and below the
+			 * cells, shifted to the west, not at all, and to the
+			 * east.  Bit 0 of the word is column pos of the source.
+			 */
+			pos = word * WORD_BITS - 1;
+
+			for (i = 0; i < 3; i++)
+			{
+				if ((row - 2 + i < 0) || (row - 2 + i >= src->rows))
+				{
+					slices[i][0] = 0;
+					slices[i][1] = 0;
+					slices[i][2] = 0;
+
+					continue;
+				}
+
+				line = src->bits + (row - 2 + i) * src->words;
+				slices[i][0] = rowWord(line, src->words, pos - 1);
+				slices[i][1] = rowWord(line, src->words, pos);
+				slices[i][2] = rowWord(line, src->words, pos + 1);
+			}
+
+			countNeighbors(sum, above, mid, below);
+
+			next = 0;
+
+			for (n = 1; n <= 8; n++)
+			{
+				if (bornRules[n] == ON)
+					next |= countIs(sum, n) & ~mid[1];
+
+				if (liveRules[n] == ON)
+					next |= countIs(sum, n) & mid[1];
+			}
+
+			if (liveRules[0] == ON)
+				next |= countIs(sum, 0) & mid[1];
+
+			wide.bits[row * wide.words + word] = next;
+		}
+	}
+
+	planeTrim(&wide, dst);
+	free(wide.bits);
+}
+
+
+/*
+ * Copy a plane into another one whose box just holds its live cells.
+ */
+static void
+planeTrim(const Plane * src, Plane * dst)
+{
+	const Bits *	line;
+	Bits *		out;
+	int		minRow;
+	int		maxRow;
+	int		minCol;
+	int		maxCol;
+	int		row;
+	int		word;
+	int		col;
+
+	minRow = src->rows;
+	maxRow = -1;
+	minCol = src->cols;
+	maxCol = -1;
+
+	for (row = 0; row < src->rows; row++)
+	{
+		line = src->bits + row * src->words;
+
+		for (word = 0; word < src->words; word++)
+		{
+			if (line[word] == 0)
+				continue;
+
+			if (row < minRow)
+				minRow = row;
+
+			maxRow = row;
+
+			col = word * WORD_BITS + __builtin_ctzll(line[word]);
+
+			if (col < minCol)
+				minCol = col;
+
+			col = word * WORD_BITS + WORD_BITS - 1 -
+				__builtin_clzll(line[word]);
+
+			if (col > maxCol)
+				maxCol = col;
+		}
+	}
+
+	dst->top = src->top;
+	dst->left = src->left;
+	dst->rows = 0;
+	dst->cols = 0;
+	dst->words = 0;
+
+	if (maxRow >= 0)
+	{
+		dst->top += minRow;
+		dst->left += minCol;
+		dst->rows = maxRow - minRow + 1;
+		dst->cols = maxCol - minCol + 1;
+		dst->words = (dst->cols + WORD_BITS - 1) / WORD_BITS;
+	}
+
+	dst->bits = (Bits *) calloc(dst->rows * dst->words + 1, sizeof(Bits));
+
+	if (dst->bits == NULL)
+		fatal("Cannot allocate simulation");
+
+	for (row = 0; row < dst->rows; row++)
+	{
+		line = src->bits + (minRow + row) * src->words;
+		out = dst->bits + row * dst->words;
+
+		for (word = 0; word < dst->words; word++)
+			out[word] = rowWord(line, src->words,
+				minCol + word * WORD_BITS);
+
+		if (dst->cols % WORD_BITS)
+			out[dst->words - 1] &=
+				(((Bits) 1) << (dst->cols % WORD_BITS)) - 1;
+	}
+}
+
+
+/*
+ * Return whether two planes hold the same cells, ignoring where their
+ * boxes are on the plane.
+ */
+static Bool
+planeSame(const Plane * plane1, const Plane * plane2)
+{
+	return (plane1->rows == plane2->rows) &&
+		(plane1->cols == plane2->cols) &&
+		(memcmp(plane1->bits, plane2->bits,
+			sizeof(Bits) * plane1->rows * plane1->words) == 0);
+}
+
+
+/*
+ * Return the word of cells of a row starting at a column, which can be a
+ * little before the start of the row.  Cells outside of the row are OFF.
+ */
+static Bits
+rowWord(const Bits * line, const int words, const int pos)
+{
+	Bits	low;
+	Bits	high;
+	int	index;
+	int	shift;
+
+	index = (pos + WORD_BITS) / WORD_BITS - 1;
+	shift = pos - index * WORD_BITS;
+
+	low = ((index >= 0) && (index < words)) ? line[index] : 0;
+	high = ((index + 1 >= 0) && (index + 1 < words)) ? line[index + 1] : 0;
+
+	if (shift == 0)
+		return low;
+
+	return (low >> shift) | (high << (WORD_BITS - shift));
+}
+
+
+/*
+ * Count the eight neighbors of each cell of a word as bit slices, given
+ * the words of the rows above, at and below the cells, each shifted to
+ * the west, not at all, and to the east.
+ */
+static void
+countNeighbors(Bits * sum, const Bits * above, const Bits * mid,
+	const Bits * below)
+{
+	Bits	s1, s2, s3;
+	Bits	c1, c2, c3;
+	Bits	k1, t1;
+	Bits	d1, d2;
+
+	fullAdd(s1, c1, above[0], above[1], above[2]);
+	fullAdd(s2, c2, below[0], below[1], below[2]);
+	s3 = mid[0] ^ mid[2];
+	c3 = mid[0] & mid[2];
+	fullAdd(sum[0], k1, s1, s2, s3);
+	fullAdd(t1, d1, c1, c2, c3);
+	sum[1] = t1 ^ k1;
+	d2 = t1 & k1;
+	sum[2] = d1 ^ d2;
+	sum[3] = d1 & d2;
+}
+
+
+/*
+ * Return the cells whose counter holds the specified value.
+ */
+static Bits
+countIs(const Bits * sum, const int count)
+{
+	return ~((sum[0] ^ -(Bits) (count & 1)) |
+		(sum[1] ^ -(Bits) ((count >> 1) & 1)) |
+		(sum[2] ^ -(Bits) ((count >> 2) & 1)) |
+		(sum[3] ^ -(Bits) ((count >> 3) & 1)));
+}
+
+/* END CODE */
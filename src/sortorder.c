@@ -28,61 +28,61 @@ int orderSortFunc(const void * addr1, const void * addr2, void * gvars)
 	// or if calculating parents, put generation 0 last
 	gen_diff = 0;
 	if (g->parent) {
-		if (c1->gen < c2->gen) gen_diff = 1;
-		if (c1->gen > c2->gen) gen_diff = -1;
+		if (cellGen(c1) < cellGen(c2)) gen_diff = 1;
+		if (cellGen(c1) > cellGen(c2)) gen_diff = -1;
 	}
 	else {
-		if (c1->gen < c2->gen) gen_diff = -1;
-		if (c1->gen > c2->gen) gen_diff = 1;
+		if (cellGen(c1) < cellGen(c2)) gen_diff = -1;
+		if (cellGen(c1) > cellGen(c2)) gen_diff = 1;
 	}
 
 	/*
 	 * If on equal position or not ordering by all generations
 	 * then sort primarily by generations
 	 */
-	if (((c1->row == c2->row) && (c1->col == c2->col)) || !g->orderGens)
+	if (((cellRow(c1) == cellRow(c2)) && (cellCol(c1) == cellCol(c2))) || !g->orderGens)
 	{
 		if (gen_diff!=0) return gen_diff;
 		// if we are here, it is the same Cell
 	}
 
 	if(g->sortOrder==SORTORDER_DIAG) {
-		if(c1->col+c1->row > c2->col+c2->row) return (g->orderInvert)?(-1):1;
-		if(c1->col+c1->row < c2->col+c2->row) return (g->orderInvert)?1:(-1);
-		if(abs(c1->col-c1->row) > abs(c2->col-c2->row)) return (g->orderWide)?1:(-1);
-		if(abs(c1->col-c1->row) < abs(c2->col-c2->row)) return (g->orderWide)?(-1):1;
+		if(cellCol(c1)+cellRow(c1) > cellCol(c2)+cellRow(c2)) return (g->orderInvert)?(-1):1;
+		if(cellCol(c1)+cellRow(c1) < cellCol(c2)+cellRow(c2)) return (g->orderInvert)?1:(-1);
+		if(abs(cellCol(c1)-cellRow(c1)) > abs(cellCol(c2)-cellRow(c2))) return (g->orderWide)?1:(-1);
+		if(abs(cellCol(c1)-cellRow(c1)) < abs(cellCol(c2)-cellRow(c2))) return (g->orderWide)?(-1):1;
 		return gen_diff;
 	}
 	if(g->sortOrder==SORTORDER_BACKDIAG) {
-		if(colMax-c1->col+c1->row > colMax-c2->col+c2->row) return (g->orderInvert)?(-1):1;
-		if(colMax-c1->col+c1->row < colMax-c2->col+c2->row) return (g->orderInvert)?1:(-1);
-		if(abs(colMax-c1->col-c1->row) > abs(colMax-c2->col-c2->row)) return (g->orderWide)?1:(-1);
-		if(abs(colMax-c1->col-c1->row) < abs(colMax-c2->col-c2->row)) return (g->orderWide)?(-1):1;
+		if(colMax-cellCol(c1)+cellRow(c1) > colMax-cellCol(c2)+cellRow(c2)) return (g->orderInvert)?(-1):1;
+		if(colMax-cellCol(c1)+cellRow(c1) < colMax-cellCol(c2)+cellRow(c2)) return (g->orderInvert)?1:(-1);
+		if(abs(colMax-cellCol(c1)-cellRow(c1)) > abs(colMax-cellCol(c2)-cellRow(c2))) return (g->orderWide)?1:(-1);
+		if(abs(colMax-cellCol(c1)-cellRow(c1)) < abs(colMax-cellCol(c2)-cellRow(c2))) return (g->orderWide)?(-1):1;
 		return gen_diff;
 	}
 	else if(g->sortOrder==SORTORDER_KNIGHT) {
-		if(c1->col*2+c1->row > c2->col*2+c2->row) return (g->orderInvert)?(-1):1;
-		if(c1->col*2+c1->row < c2->col*2+c2->row) return (g->orderInvert)?1:(-1);
-		if(abs(c1->col-c1->row) > abs(c2->col-c2->row)) return (g->orderWide)?1:(-1);
-		if(abs(c1->col-c1->row) < abs(c2->col-c2->row)) return (g->orderWide)?(-1):1;
+		if(cellCol(c1)*2+cellRow(c1) > cellCol(c2)*2+cellRow(c2)) return (g->orderInvert)?(-1):1;
+		if(cellCol(c1)*2+cellRow(c1) < cellCol(c2)*2+cellRow(c2)) return (g->orderInvert)?1:(-1);
+		if(abs(cellCol(c1)-cellRow(c1)) > abs(cellCol(c2)-cellRow(c2))) return (g->orderWide)?1:(-1);
+		if(abs(cellCol(c1)-cellRow(c1)) < abs(cellCol(c2)-cellRow(c2))) return (g->orderWide)?(-1):1;
 		return gen_diff;
 	}
 	else if(g->sortOrder==SORTORDER_TOPDOWN) {
-		if(c1->row > c2->row) return (g->orderInvert)?(-1):1;
-		if(c1->row < c2->row) return (g->orderInvert)?1:(-1);
+		if(cellRow(c1) > cellRow(c2)) return (g->orderInvert)?(-1):1;
+		if(cellRow(c1) < cellRow(c2)) return (g->orderInvert)?1:(-1);
 		midcol = (g->colMax + 1) / 2;
-		dif1 = abs(c1->col - midcol);
-		dif2 = abs(c2->col - midcol);
+		dif1 = abs(cellCol(c1) - midcol);
+		dif2 = abs(cellCol(c2) - midcol);
 		if (dif1 < dif2) return (g->orderWide ? -1 : 1);
 		if (dif1 > dif2) return (g->orderWide ? 1 : -1);
 		return gen_diff;
 	}
 	else if(g->sortOrder==SORTORDER_LEFTRIGHT) {
-		if(c1->col > c2->col) return (g->orderInvert)?(-1):1;
-		if(c1->col < c2->col) return (g->orderInvert)?1:(-1);
+		if(cellCol(c1) > cellCol(c2)) return (g->orderInvert)?(-1):1;
+		if(cellCol(c1) < cellCol(c2)) return (g->orderInvert)?1:(-1);
 		midrow = (g->rowMax + 1) / 2;
-		dif1 = abs(c1->row - midrow);
-		dif2 = abs(c2->row - midrow);
+		dif1 = abs(cellRow(c1) - midrow);
+		dif2 = abs(cellRow(c2) - midrow);
 		if (dif1 < dif2) return (g->orderWide ? -1 : 1);
 		if (dif1 > dif2) return (g->orderWide ? 1 : -1);
 		return gen_diff;
@@ -91,10 +91,10 @@ int orderSortFunc(const void * addr1, const void * addr2, void * gvars)
 		double midcolf, midrowf, d1, d2;
 		midcolf = (1.0+(double)g->colMax) / 2.0;
 		midrowf = (1.0+(double)g->rowMax) / 2.0;
-		d1 = (midcolf-(double)c1->col)*(midcolf-(double)c1->col) + 
-			(midrowf-(double)c1->row)*(midrowf-(double)c1->row);
-		d2 = (midcolf-(double)c2->col)*(midcolf-(double)c2->col) + 
-			(midrowf-(double)c2->row)*(midrowf-(double)c2->row);
+		d1 = (midcolf-(double)cellCol(c1))*(midcolf-(double)cellCol(c1)) + 
+			(midrowf-(double)cellRow(c1))*(midrowf-(double)cellRow(c1));
+		d2 = (midcolf-(double)cellCol(c2))*(midcolf-(double)cellCol(c2)) + 
+			(midrowf-(double)cellRow(c2))*(midrowf-(double)cellRow(c2));
 		if(d1>d2) return 1;
 		if(d1<d2) return -1;
 		return gen_diff;
@@ -102,14 +102,14 @@ int orderSortFunc(const void * addr1, const void * addr2, void * gvars)
 	else if(g->orderMiddle || g->sortOrder==SORTORDER_MIDDLECOLOUT) {
 		// the ordering is from the center column outwards
 		midcol = (g->colMax + 1) / 2;
-		dif1 = abs(c1->col - midcol);
-		dif2 = abs(c2->col - midcol);
+		dif1 = abs(cellCol(c1) - midcol);
+		dif2 = abs(cellCol(c2) - midcol);
 		if (dif1 < dif2) return -1;
 		if (dif1 > dif2) return 1;
 
 		midrow = (g->rowMax + 1) / 2;
-		dif1 = abs(c1->row - midrow);
-		dif2 = abs(c2->row - midrow);
+		dif1 = abs(cellRow(c1) - midrow);
+		dif2 = abs(cellRow(c2) - midrow);
 		if (dif1 < dif2) return (g->orderWide ? -1 : 1);
 		if (dif1 > dif2) return (g->orderWide ? 1 : -1);
 		return gen_diff;
@@ -117,8 +117,8 @@ int orderSortFunc(const void * addr1, const void * addr2, void * gvars)
 
 	// else left-to-right sort order
 
-	if (c1->col < c2->col) return -1;
-	if (c1->col > c2->col) return 1;
+	if (cellCol(c1) < cellCol(c2)) return -1;
+	if (cellCol(c1) > cellCol(c2)) return 1;
 
 	/*
 	 * Sort on the row number.
@@ -129,8 +129,8 @@ int orderSortFunc(const void * addr1, const void * addr2, void * gvars)
 	 * for new Cells is OFF.
 	 */
 	midrow = (g->rowMax + 1) / 2;
-	dif1 = abs(c1->row - midrow);
-	dif2 = abs(c2->row - midrow);
+	dif1 = abs(cellRow(c1) - midrow);
+	dif2 = abs(cellRow(c2) - midrow);
 	if (dif1 < dif2) return (g->orderWide ? -1 : 1);
 	if (dif1 > dif2) return (g->orderWide ? 1 : -1);
 
@@ -166,10 +166,10 @@ orderSortFuncOld(const void * addr1, const void * addr2, const void *gvars)
 	 */
 	if (!g->orderGens)
 	{
-		if (c1->gen < c2->gen)
+		if (cellGen(c1) < cellGen(c2))
 			return -1;
 
-		if (c1->gen > c2->gen)
+		if (cellGen(c1) > cellGen(c2))
 			return 1;
 	}
 
@@ -183,12 +183,12 @@ orderSortFuncOld(const void * addr1, const void * addr2, const void *gvars)
 	{
 		midCol = (colMax + 1) / 2;
 
-		dif1 = c1->col - midCol;
+		dif1 = cellCol(c1) - midCol;
 
 		if (dif1 < 0)
 			dif1 = -dif1;
 
-		dif2 = c2->col - midCol;
+		dif2 = cellCol(c2) - midCol;
 
 		if (dif2 < 0)
 			dif2 = -dif2;
@@ -201,18 +201,18 @@ orderSortFuncOld(const void * addr1, const void * addr2, const void *gvars)
 	}
 	else
 	{
-		if (c1->col < c2->col)
+		if (cellCol(c1) < cellCol(c2))
 			return -1;
 
-		if (c1->col > c2->col)
+		if (cellCol(c1) > cellCol(c2))
 			return 1;
 	}
 
 	/*
 	 * Sort "even" positions ahead of "odd" positions.
 	 */
-	dif1 = (c1->row + c1->col + c1->gen) & 0x01;
-	dif2 = (c2->row + c2->col + c2->gen) & 0x01;
+	dif1 = (cellRow(c1) + cellCol(c1) + cellGen(c1)) & 0x01;
+	dif2 = (cellRow(c2) + cellCol(c2) + cellGen(c2)) & 0x01;
 
 	if (dif1 != dif2)
 		return dif1 - dif2;
@@ -227,12 +227,12 @@ orderSortFuncOld(const void * addr1, const void * addr2, const void *gvars)
 	 */
 	midRow = (g->rowMax + 1) / 2;
 
-	dif1 = c1->row - midRow;
+	dif1 = cellRow(c1) - midRow;
 
 	if (dif1 < 0)
 		dif1 = -dif1;
 
-	dif2 = c2->row - midRow;
+	dif2 = cellRow(c2) - midRow;
 
 	if (dif2 < 0)
 		dif2 = -dif2;
@@ -246,10 +246,10 @@ orderSortFuncOld(const void * addr1, const void * addr2, const void *gvars)
 	/*
 	 * Sort by the generation again if we didn't do it yet.
 	 */
-	if (c1->gen < c2->gen)
+	if (cellGen(c1) < cellGen(c2))
 		return -1;
 
-	if (c1->gen > c2->gen)
+	if (cellGen(c1) > cellGen(c2))
 		return 1;
 
 	return 0;
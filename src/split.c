@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "setstate.h"
+#include "split.h"
+#include "leader.h"
+
+/*
+ * Splitting of a search into parts which can be searched separately.
+ * A part is split by choosing its next cell the way that the search does,
+ * and making a new part for each state of that cell which is consistent.
+ * The part with the largest estimated size is split next, until there
+ * are enough parts.  Each part is then dumped to a file of its own, with
+ * the cells leading to it set as forced below the base of its search,
+ * so that the parts are disjoint and together cover the whole search.
+ */
+
+#define	SPLIT_DIVES	16	/* random dives for estimating a part */
+#define	SPLIT_SEED	1	/* seed for the random dives */
+
+
+/*
+ * One of the cells leading to a part, and the state it is set to.
+ */
+typedef struct
+{
+	short	row;
+	short	col;
+	short	gen;
+	short	state;
+} SplitCell;
+
+/*
+ * A part of the search.
+ */
+typedef struct
+{
+	SplitCell *	cells;	/* cells leading to the part */
+	int		count;	/* number of those cells */
+	double		size;	/* estimated number of nodes */
+	Bool		done;	/* part cannot be split further */
+} Part;
+
+
+static SEARCH_LOCAL Cell **	rootSet;	/* base of the whole search */
+static SEARCH_LOCAL unsigned int	seed;	/* state of the random dives */
+
+static void	clearTo(Cell ** const);
+static Bool	setPart(const Part * const);
+static double	estimate(void);
+
+
+/*
+ * Split the search into the specified number of parts, writing each of
+ * them as a dump file named by the prefix and the number of the part.
+ * Fewer parts are written if the search cannot be split that far.  Parts
+ * which are already complete objects are written to the output file, or
+ * to the standard output, instead of being dumped, since a search loaded
+ * from such a dump would back up over the object without reporting it.
+ * The search is split from its base, so the progress made by a search
+ * loaded from a dump is not kept.
+ * Returns the exit status for the program.
+ */
+int
+splitSearch(const int count, const char * const file)
+{
+	Part *	parts;
+	Part *	part;
+	Part	parent;
+	Cell **	mark;
+	Cell *	cell;
+	State	state;
+	char *	name;
+	int	partCount;
+	int	dumpCount;
+	int	best;
+	int	i;
+
+	parts = (Part *) malloc(sizeof(Part) * (count + 1));
+	name = (char *) malloc(strlen(file) + 16);
+
+	if ((parts == NULL) || (name == NULL))
+		fatal("Cannot allocate parts");
+
+	seed = SPLIT_SEED;
+
+	leaderStart();
+
+	clearTo(baseSet);
+	rootSet = baseSet;
+
+	parts[0].cells = NULL;
+	parts[0].count = 0;
+	parts[0].size = estimate();
+	parts[0].done = FALSE;
+	partCount = 1;
+
+	/*
+	 * Split the largest part which can still be split until there
+	 * are enough parts.
+	 */
+	while (partCount < count)
+	{
+		best = -1;
+
+		for (i = 0; i < partCount; i++)
+		{
+			if (!parts[i].done &&
+				((best < 0) || (parts[i].size > parts[best].size)))
+			{
+				best = i;
+			}
+		}
+
+		if (best < 0)
+			break;
+
+		clearTo(rootSet);
+		setPart(&parts[best]);
+
+		cell = nextChoice(&state);
+
+		if (cell == NULL_CELL)
+		{
+			parts[best].done = TRUE;
+
+			continue;
+		}
+
+		parent = parts[best];
+		parts[best] = parts[--partCount];
+
+		for (i = 0; i < 2; i++)
+		{
+			mark = newSet;
+
+			if (proceed(cell, state, FALSE) == OK)
+			{
+				part = &parts[partCount++];
+				part->count = parent.count + 1;
+				part->cells = (SplitCell *)
+					malloc(sizeof(SplitCell) * part->count);
+
+				if (part->cells == NULL)
+					fatal("Cannot allocate parts");
+
+				if (parent.count)
+				{
+					memcpy(part->cells, parent.cells,
+						sizeof(SplitCell) * parent.count);
+				}
+
+				part->cells[parent.count].row = cellRow(cell);
+				part->cells[parent.count].col = cellCol(cell);
+				part->cells[parent.count].gen = cellGen(cell);
+				part->cells[parent.count].state = state;
+				part->size = estimate();
+				part->done = FALSE;
+			}
+
+			clearTo(mark);
+			state = 1 - state;
+		}
+
+		free(parent.cells);
+	}
+
+	if (partCount == 0)
+	{
+		printf("No objects exist, so nothing was written.\n");
+
+		return 1;
+	}
+
+	/*
+	 * Write each part with the cells leading to it below its base.
+	 */
+	dumpCount = 0;
+
+	for (i = 0; i < partCount; i++)
+	{
+		clearTo(rootSet);
+
+		if (!setPart(&parts[i]))
+			fatal("Cannot set the cells of a part");
+
+		if (nextChoice(&state) == NULL_CELL)
+		{
+			if (acceptObject())
+				writeGen(outputFile ? outputFile : ".", TRUE);
+
+			free(parts[i].cells);
+
+			continue;
+		}
+
+		baseSet = nextSet;
+		sprintf(name, "%s.%d", file, ++dumpCount);
+
+		if (writeDump(name) != OK)
+		{
+			fprintf(stderr, "Cannot write \"%s\"\n", name);
+
+			return 1;
+		}
+
+		printf("Part %d in \"%s\" has about %.0f nodes\n",
+			dumpCount, name, parts[i].size);
+
+		baseSet = rootSet;
+		free(parts[i].cells);
+	}
+
+	free(parts);
+	free(name);
+
+	return 0;
+}
+
+
+/*
+ * Clear all of the settings made after the specified position in the
+ * setting table.
+ */
+static void
+clearTo(Cell ** const mark)
+{
+	Cell *	cell;
+
+	while (newSet > mark)
+	{
+		cell = *--newSet;
+		setVar(cell, UNK);
+		cell->flags |= FREECELL;
+	}
+
+	nextSet = newSet;
+}
+
+
+/*
+ * Set the cells leading to a part as forced.
+ * Returns TRUE if they were all set consistently.
+ */
+static Bool
+setPart(const Part * const part)
+{
+	const SplitCell *	sc;
+	int			i;
+
+	for (i = 0; i < part->count; i++)
+	{
+		sc = &part->cells[i];
+
+		if (proceed(findCell(sc->row, sc->col, sc->gen), sc->state,
+			FALSE) != OK)
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
+/*
+ * Estimate the number of nodes in the search from the current settings.
+ * Each random dive chooses cells down to the bottom of the search, trying
+ * both states of each one and going on with a random consistent one.
+ * The product of the numbers of consistent states along the way then
+ * estimates the number of nodes at each depth (Knuth's method), and the
+ * totals of the dives are averaged.  The settings are restored afterwards.
+ */
+static double
+estimate(void)
+{
+	Cell **	mark;
+	Cell **	level;
+	Cell *	cell;
+	State	state;
+	Bool	good[2];
+	double	weight;
+	double	total;
+	int	dive;
+	int	ways;
+
+	mark = newSet;
+	total = 0;
+
+	for (dive = 0; dive < SPLIT_DIVES; dive++)
+	{
+		weight = 1;
+
+		for (;;)
+		{
+			total += weight;
+			cell = nextChoice(&state);
+
+			if (cell == NULL_CELL)
+				break;
+
+			level = newSet;
+
+			for (state = OFF; state <= ON; state++)
+			{
+				good[state] = (proceed(cell, state, FALSE) == OK);
+				clearTo(level);
+			}
+
+			ways = good[OFF] + good[ON];
+
+			if (ways == 0)
+				break;
+
+			weight *= ways;
+			state = (ways == 2) ? (rand_r(&seed) & 1) : good[ON];
+			proceed(cell, state, FALSE);
+		}
+
+		clearTo(mark);
+	}
+
+	return total / SPLIT_DIVES;
+}
+
+/* END CODE */
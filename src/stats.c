@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "stats.h"
+
+/*
+ * Statistics of the search for monitoring.
+ * The counters are simple increments made by the search itself, and they
+ * are only looked at when the view timer goes off, and once more when the
+ * search ends.  Each time, one line holding a JSON object is appended to
+ * the statistics file, giving the totals so far and the rates since the
+ * line before it.  The fraction of the search which is done, and so the
+ * time left, is estimated from the cells which are chosen at the time.
+ */
+
+static SEARCH_LOCAL double	startTime;	/* time the search started */
+static SEARCH_LOCAL double	lastTime;	/* time of the last record */
+static SEARCH_LOCAL long	lastNodes;	/* nodes at the last record */
+static SEARCH_LOCAL long	lastConfl;	/* conflicts at the last record */
+static SEARCH_LOCAL long	lastProps;	/* propagations at the last record */
+static SEARCH_LOCAL double	startDone;	/* fraction done at the start */
+
+static double	now(void);
+
+
+/*
+ * Remember when the search started.
+ */
+void
+statsStart(void)
+{
+	startTime = now();
+	lastTime = startTime;
+	lastNodes = nodeCount;
+	lastConfl = stepConfl;
+	lastProps = propCount;
+	startDone = searchDone();
+}
+
+
+/*
+ * Append a record of the current statistics to the statistics file.
+ */
+void
+writeStats(void)
+{
+	FILE *	fp;
+	double	when;
+	double	span;
+	double	eta;
+
+	if (startTime == 0)
+		statsStart();
+
+	fp = fopen(statsFile, "a");
+
+	if (fp == NULL)
+	{
+		ttyStatus("Cannot create \"%s\"\n", statsFile);
+
+		return;
+	}
+
+	when = now();
+	span = when - lastTime;
+
+	if (span <= 0)
+		span = 1;
+
+	eta = searchEta();
+
+	fprintf(fp, "{\"elapsed\":%.3f,\"nodes\":%ld,\"conflicts\":%ld,"
+		"\"propagations\":%ld,\"depth\":%ld,\"max_depth\":%ld,"
+		"\"found\":%ld,\"nodes_per_sec\":%.1f,"
+		"\"conflicts_per_sec\":%.1f,\"propagations_per_sec\":%.1f,"
+		"\"fraction_done\":%.6f,",
+		when - startTime, nodeCount, stepConfl, propCount,
+		(long) (newSet - setTable), maxDepth, foundCount,
+		(nodeCount - lastNodes) / span, (stepConfl - lastConfl) / span,
+		(propCount - lastProps) / span, searchDone());
+
+	if (eta < 0)
+		fprintf(fp, "\"eta_sec\":null}\n");
+	else
+		fprintf(fp, "\"eta_sec\":%.0f}\n", eta);
+
+	fclose(fp);
+
+	lastTime = when;
+	lastNodes = nodeCount;
+	lastConfl = stepConfl;
+	lastProps = propCount;
+}
+
+
+/*
+ * Estimate the fraction of the search which is done.
+ * Each chosen cell splits the part of the search below it into two
+ * halves, one for each of its states.  A chosen cell which is no longer
+ * free is trying its second state, so the first half is done.  Taking the
+ * halves to be the same size, each such cell adds the size of its half.
+ * A search which has ended is all done.
+ */
+double
+searchDone(void)
+{
+	Cell **	set;
+	double	part;
+	double	done;
+
+	if (curStatus == NOT_EXIST)
+		return 1.0;
+
+	part = 1.0;
+	done = 0.0;
+
+	for (set = baseSet; set != newSet; set++)
+	{
+		if (!((*set)->flags & CHOSENCELL))
+			continue;
+
+		part /= 2;
+
+		if (!((*set)->flags & FREECELL))
+			done += part;
+	}
+
+	return done;
+}
+
+
+/*
+ * Estimate the number of seconds left in the search from how fast the
+ * fraction done has grown since the search started.
+ * Returns -1 if there is no estimate yet, or after restarts have thrown
+ * away the progress.
+ */
+double
+searchEta(void)
+{
+	double	elapsed;
+	double	done;
+
+	if (startTime == 0)
+		return -1;
+
+	elapsed = now() - startTime;
+	done = searchDone();
+
+	if ((elapsed <= 0) || (done <= startDone))
+		return -1;
+
+	return elapsed * (1 - done) / (done - startDone);
+}
+
+
+/*
+ * Return the time in seconds from a fixed point.
+ */
+static double
+now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* END CODE */
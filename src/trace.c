@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "trace.h"
+#include "outputtimers.h"
+
+/*
+ * Tracing of the search.
+ * While tracing is turned on, each setting, backing up, choice and
+ * contradiction of the search is kept as a small binary event in a ring
+ * buffer, which holds the latest events.  The buffer is written to the
+ * trace file when asked for and when the program exits, and the file is
+ * turned back into readable messages later by "lifesrc --decode file".
+ * Since nothing is printed while searching, searches of the usual size
+ * can be traced, and tracing can be turned on without rebuilding.  Each
+ * search thread has its own buffer, which is written when its search is
+ * destroyed, while the buffer of the main program is written at exit.
+ */
+
+#define	TRACE_SIZE	(1 << 20)	/* number of events kept */
+#define	TRACE_MAGIC	"LSRCTRAC"	/* start of trace file */
+#define	TRACE_VERSION	1		/* version of trace file */
+
+
+/*
+ * One event, which is the offset of its cell in the cell table along with
+ * the kind of event and the state involved.
+ */
+typedef struct
+{
+	unsigned int	off;		/* offset of the cell */
+	unsigned char	kind;		/* kind of event */
+	unsigned char	state;		/* state of the cell */
+	unsigned char	free;		/* cell was free to choose */
+	unsigned char	spare;		/* unused */
+} Event;
+
+
+/*
+ * The shape of the cell table, which is needed to find the coordinates
+ * of the cells from their offsets when decoding.
+ */
+typedef struct
+{
+	int		version;	/* version of the file */
+	int		genMax;		/* number of generations */
+	int		colStride;	/* offset between adjacent columns */
+	int		genStride;	/* offset between adjacent generations */
+	int		cellPad;	/* padding around the cells */
+	unsigned long	count;		/* number of events which follow */
+	unsigned long	total;		/* number of events ever traced */
+} Header;
+
+
+static SEARCH_LOCAL Event *		ring;		/* ring buffer of events */
+static SEARCH_LOCAL unsigned long	eventCount;	/* events ever traced */
+
+static pthread_once_t	traceOnce = PTHREAD_ONCE_INIT;
+
+static void	traceSetup(void);
+static void	traceExit(void);
+static const char *	stateName(const int);
+
+
+/*
+ * Turn tracing on, making the buffer if it does not exist yet.
+ */
+void
+traceStart(void)
+{
+	if (ring == NULL)
+	{
+		ring = (Event *) malloc(sizeof(Event) * TRACE_SIZE);
+
+		if (ring == NULL)
+			fatal("Cannot allocate trace buffer");
+
+		eventCount = 0;
+	}
+
+	pthread_once(&traceOnce, traceSetup);
+
+	tracing = TRUE;
+}
+
+
+/*
+ * Set up the writing of the trace for the whole process, which is done
+ * when the program exits and when it gets the SIGHUP signal.
+ */
+static void
+traceSetup(void)
+{
+	static struct sigaction	actTrace;
+
+	atexit(traceExit);
+	setSigaction(&actTrace, SIGHUP, &alarm_handler);
+}
+
+
+/*
+ * Turn tracing off, keeping the events already traced.
+ */
+void
+traceStop(void)
+{
+	tracing = FALSE;
+}
+
+
+/*
+ * Add an event to the buffer, replacing the oldest event if it is full.
+ */
+void
+traceEvent(const int kind, const Cell * const cell, const State state,
+	const Bool free)
+{
+	Event *	event;
+
+	event = &ring[eventCount++ & (TRACE_SIZE - 1)];
+	event->off = cellOffset(cell);
+	event->kind = kind;
+	event->state = state;
+	event->free = free;
+}
+
+
+/*
+ * Write the trace of the search to its file if anything was traced, and
+ * free the buffer.
+ */
+void
+traceEnd(void)
+{
+	if (ring == NULL)
+		return;
+
+	writeTrace(traceFile ? traceFile : TRACE_FILE);
+
+	free(ring);
+	ring = NULL;
+	tracing = FALSE;
+}
+
+
+/*
+ * Write the trace file when the program exits.
+ */
+static void
+traceExit(void)
+{
+	traceEnd();
+}
+
+
+/*
+ * Write the events in the buffer to a file, from the oldest one to the
+ * newest one.
+ */
+void
+writeTrace(const char * file)
+{
+	FILE *		fp;
+	Header		header;
+	unsigned long	first;
+	unsigned long	i;
+
+	if (ring == NULL)
+	{
+		ttyStatus("Nothing has been traced, use -D\n");
+
+		return;
+	}
+
+	fp = fopen(file, "wb");
+
+	if (fp == NULL)
+	{
+		ttyStatus("Cannot create \"%s\"\n", file);
+
+		return;
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.version = TRACE_VERSION;
+	header.genMax = genMax;
+	header.colStride = colStride;
+	header.genStride = genStride;
+	header.cellPad = CELL_PAD;
+	header.total = eventCount;
+	header.count = eventCount;
+
+	if (header.count > TRACE_SIZE)
+		header.count = TRACE_SIZE;
+
+	first = eventCount - header.count;
+
+	fwrite(TRACE_MAGIC, 1, strlen(TRACE_MAGIC), fp);
+	fwrite(&header, sizeof(header), 1, fp);
+
+	for (i = first; i < eventCount; i++)
+		fwrite(&ring[i & (TRACE_SIZE - 1)], sizeof(Event), 1, fp);
+
+	if (fclose(fp))
+	{
+		ttyStatus("Error writing \"%s\"\n", file);
+
+		return;
+	}
+
+	ttyStatus("Trace of %lu events written to \"%s\"\n", header.count, file);
+}
+
+
+/*
+ * Print the events of a trace file as readable messages.
+ * Returns the exit status for the program.
+ */
+int
+decodeTrace(const char * file)
+{
+	FILE *		fp;
+	Header		header;
+	Event		event;
+	char		magic[sizeof(TRACE_MAGIC)];
+	int		row;
+	int		col;
+	int		gen;
+
+	fp = fopen(file, "rb");
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Cannot open \"%s\"\n", file);
+
+		return 1;
+	}
+
+	if ((fread(magic, 1, strlen(TRACE_MAGIC), fp) != strlen(TRACE_MAGIC)) ||
+		memcmp(magic, TRACE_MAGIC, strlen(TRACE_MAGIC)) ||
+		(fread(&header, sizeof(header), 1, fp) != 1) ||
+		(header.version != TRACE_VERSION))
+	{
+		fprintf(stderr, "\"%s\" is not a trace file\n", file);
+		fclose(fp);
+
+		return 1;
+	}
+
+	if (header.total > header.count)
+		printf("(%lu earlier events were not kept)\n",
+			header.total - header.count);
+
+	while (fread(&event, sizeof(event), 1, fp) == 1)
+	{
+		gen = event.off / header.genStride;
+		col = event.off % header.genStride / header.colStride -
+			header.cellPad;
+		row = event.off % header.genStride % header.colStride -
+			header.cellPad;
+
+		switch (event.kind)
+		{
+			case TRACE_SET:
+				printf("setCell %d %d %d to %s, %s successful\n",
+					row, col, gen,
+					(event.free ? "free" : "forced"),
+					stateName(event.state));
+				break;
+
+			case TRACE_FORCE:
+				printf("Forcing unknown neighbors of cell %d %d %d %s\n",
+					row, col, gen, stateName(event.state));
+				break;
+
+			case TRACE_CONFLICT:
+				printf("setCell %d %d %d to state %s inconsistent\n",
+					row, col, gen, stateName(event.state));
+				break;
+
+			case TRACE_BACKUP:
+				printf("backing up cell %d %d %d, was %s, %s\n",
+					row, col, gen, stateName(event.state),
+					(event.free ? "free" : "forced"));
+				break;
+
+			case TRACE_DECIDE:
+				printf("Choosing cell %d %d %d to be %s\n",
+					row, col, gen, stateName(event.state));
+				break;
+
+			case TRACE_EXAMINE:
+				printf("Examining saved cell %d %d %d (%s) for consistency\n",
+					row, col, gen,
+					(event.free ? "free" : "forced"));
+				break;
+
+			default:
+				printf("Unknown event %d for cell %d %d %d\n",
+					event.kind, row, col, gen);
+				break;
+		}
+	}
+
+	fclose(fp);
+
+	return 0;
+}
+
+
+/*
+ * Return the name of a state as used in the messages.
+ */
+static const char *
+stateName(const int state)
+{
+	if (state == ON)
+		return "on";
+
+	if (state == OFF)
+		return "off";
+
+	return "unknown";
+}
+
+/* END CODE */
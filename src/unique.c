@@ -0,0 +1,445 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/file.h>
+
+#include "lifesrc.h"
+#include "state.h"
+#include "unique.h"
+
+/*
+ * Suppression of objects which were already found.
+ * An object is often found again in another of its phases, moved within
+ * the search area, or reflected or rotated, and all of those are really
+ * the same object.  Each object found is reduced to a canonical form,
+ * which is the smallest of the bounding boxes of all of its phases in all
+ * eight orientations, and the hash of that form is kept in a set.  Objects
+ * whose hashes are already in the set are skipped.  A set is shared by all
+ * of the searches run by the process, and it can also be kept in a file of
+ * hashes, one per line, so that the worker processes of -j, the jobs of a
+ * campaign, and later runs all share it too.  When -j is used without a
+ * file, a temporary file is used so that the workers still share the set.
+ */
+
+#define	UNIQUE_SIZE	1024	/* initial size of a table of hashes */
+#define	FNV_BASIS	14695981039346656037ULL
+#define	FNV_PRIME	1099511628211ULL
+
+
+typedef unsigned long long	Hash;
+
+
+/*
+ * A set of the hashes of objects, which is kept either only in memory or
+ * in a file as well.
+ */
+typedef struct UniqueSet
+{
+	struct UniqueSet *	next;	/* next set in use */
+	char *		path;		/* file of the set, or NULL */
+	FILE *		fp;		/* open file of the set */
+	long		readPos;	/* position the file was read up to */
+	Hash *		table;		/* open addressed table of hashes */
+	long		size;		/* size of the table */
+	long		count;		/* number of hashes in the table */
+} UniqueSet;
+
+
+static UniqueSet *	setList;	/* list of the sets in use */
+static char *		sharePath;	/* temporary file shared by workers */
+static pthread_mutex_t	uniqueLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static UniqueSet *	findSet(const char *);
+static Bool	addHash(UniqueSet *, Hash);
+static void	readHashes(UniqueSet *);
+static Hash	objectHash(void);
+static int	phaseForm(const int, unsigned char *, unsigned char *);
+
+
+/*
+ * Check whether the object just found is new, and remember it if so.
+ * The file of the set is locked while it is read and written, so that
+ * other processes sharing it see each object only once.
+ * Returns TRUE if the object was not found before, or if duplicates are
+ * not being suppressed.
+ */
+Bool
+uniqueObject(void)
+{
+	UniqueSet *	set;
+	Hash		hash;
+	Bool		isNew;
+
+	if (!uniqueObjects)
+		return TRUE;
+
+	hash = objectHash();
+
+	pthread_mutex_lock(&uniqueLock);
+
+	set = findSet(uniqueFile);
+
+	if (set->fp)
+	{
+		flock(fileno(set->fp), LOCK_EX);
+		readHashes(set);
+	}
+
+	isNew = addHash(set, hash);
+
+	if (set->fp)
+	{
+		if (isNew)
+		{
+			fseek(set->fp, 0, SEEK_END);
+			fprintf(set->fp, "%016llx\n", hash);
+			fflush(set->fp);
+			set->readPos = ftell(set->fp);
+		}
+
+		flock(fileno(set->fp), LOCK_UN);
+	}
+
+	pthread_mutex_unlock(&uniqueLock);
+
+	return isNew;
+}
+
+
+/*
+ * Make the objects found shared by the worker processes which are about
+ * to be forked.  A set kept only in memory would be copied into each of
+ * them separately, so it is kept in a temporary file instead until
+ * uniqueUnshare is called.
+ */
+void
+uniqueShare(void)
+{
+	const char *	dir;
+	int		fd;
+
+	if (!uniqueObjects || uniqueFile)
+		return;
+
+	dir = getenv("TMPDIR");
+
+	if ((dir == NULL) || (*dir == '\0'))
+		dir = "/tmp";
+
+	sharePath = (char *) malloc(strlen(dir) + 20);
+
+	if (sharePath == NULL)
+		fatal("Cannot allocate unique objects");
+
+	sprintf(sharePath, "%s/lifesrcXXXXXX", dir);
+	fd = mkstemp(sharePath);
+
+	if (fd < 0)
+		fatal("Cannot create unique objects file");
+
+	close(fd);
+	uniqueFile = sharePath;
+}
+
+
+/*
+ * Remove the temporary file of the objects found once the worker
+ * processes are done with it.
+ */
+void
+uniqueUnshare(void)
+{
+	if (sharePath == NULL)
+		return;
+
+	remove(sharePath);
+
+	if (uniqueFile == sharePath)
+		uniqueFile = NULL;
+
+	free(sharePath);
+	sharePath = NULL;
+}
+
+
+/*
+ * Find the set kept in the given file, or the set kept only in memory if
+ * the file is NULL, creating the set if it is not in use yet.
+ */
+static UniqueSet *
+findSet(const char * path)
+{
+	UniqueSet *	set;
+
+	for (set = setList; set; set = set->next)
+	{
+		if ((path == NULL) ? (set->path == NULL) :
+			(set->path && (strcmp(set->path, path) == 0)))
+		{
+			return set;
+		}
+	}
+
+	set = (UniqueSet *) calloc(1, sizeof(UniqueSet));
+
+	if (set == NULL)
+		fatal("Cannot allocate unique objects");
+
+	set->size = UNIQUE_SIZE;
+	set->table = (Hash *) calloc(set->size, sizeof(Hash));
+
+	if (set->table == NULL)
+		fatal("Cannot allocate unique objects");
+
+	if (path)
+	{
+		set->path = strdup(path);
+		set->fp = fopen(path, "a+");
+
+		if ((set->path == NULL) || (set->fp == NULL))
+			fatal("Cannot open unique objects file");
+	}
+
+	set->next = setList;
+	setList = set;
+
+	return set;
+}
+
+
+/*
+ * Add a hash to a set, growing the table when it gets half full.
+ * Returns TRUE if the hash was not already in the set.
+ */
+static Bool
+addHash(UniqueSet * set, Hash hash)
+{
+	Hash *	oldTable;
+	long	oldSize;
+	long	i;
+
+	/*
+	 * Zero marks an empty slot of the table.
+	 */
+	if (hash == 0)
+		hash = 1;
+
+	if (set->count * 2 >= set->size)
+	{
+		oldTable = set->table;
+		oldSize = set->size;
+
+		set->size *= 2;
+		set->table = (Hash *) calloc(set->size, sizeof(Hash));
+		set->count = 0;
+
+		if (set->table == NULL)
+			fatal("Cannot allocate unique objects");
+
+		for (i = 0; i < oldSize; i++)
+		{
+			if (oldTable[i])
+				addHash(set, oldTable[i]);
+		}
+
+		free(oldTable);
+	}
+
+	for (i = hash & (set->size - 1); set->table[i];
+		i = (i + 1) & (set->size - 1))
+	{
+		if (set->table[i] == hash)
+			return FALSE;
+	}
+
+	set->table[i] = hash;
+	set->count++;
+
+	return TRUE;
+}
+
+
+/*
+ * Read the hashes added to the file of a set since it was last read,
+ * which includes those written by other processes.
+ */
+static void
+readHashes(UniqueSet * set)
+{
+	char	buf[80];
+
+	fseek(set->fp, set->readPos, SEEK_SET);
+
+	while (fgets(buf, sizeof(buf), set->fp))
+	{
+		if (strchr(buf, '\n'))
+			addHash(set, strtoull(buf, NULL, 16));
+	}
+
+	clearerr(set->fp);
+	set->readPos = ftell(set->fp);
+}
+
+
+/*
+ * Return the hash of the canonical form of the object, which is the
+ * smallest of the forms of its phases.  When looking for parents the
+ * generations are not phases of the same object, so only generation 0
+ * is used.
+ */
+static Hash
+objectHash(void)
+{
+	unsigned char *	best;
+	unsigned char *	phase;
+	unsigned char *	form;
+	Hash		hash;
+	int		size;
+	int		len;
+	int		bestLen;
+	int		gen;
+	int		i;
+
+	size = 4 + rowMax * colMax;
+	best = (unsigned char *) malloc(size * 3);
+
+	if (best == NULL)
+		fatal("Cannot allocate unique objects");
+
+	phase = best + size;
+	form = phase + size;
+	bestLen = 0;
+
+	for (gen = 0; gen < (parent ? 1 : genMax); gen++)
+	{
+		len = phaseForm(gen, phase, form);
+
+		if ((gen == 0) || (memcmp(phase, best, len) < 0))
+		{
+			memcpy(best, phase, len);
+			bestLen = len;
+		}
+	}
+
+	hash = FNV_BASIS;
+
+	for (i = 0; i < bestLen; i++)
+	{
+		hash ^= best[i];
+		hash *= FNV_PRIME;
+	}
+
+	free(best);
+
+	return hash;
+}
+
+
+/*
+ * Find the form of a generation, which is the smallest of the bounding
+ * boxes of its ON cells in each of the eight orientations.  A box is kept
+ * as its height and width in two bytes each followed by a byte for each
+ * cell row by row, so that comparing the bytes compares boxes by their
+ * height, then their width, and then their cells.  The form is stored
+ * in the first buffer using the second as scratch, and its length is
+ * returned.
+ */
+static int
+phaseForm(const int gen, unsigned char * best, unsigned char * form)
+{
+	unsigned char *	cp;
+	int		minRow;
+	int		maxRow;
+	int		minCol;
+	int		maxCol;
+	int		height;
+	int		width;
+	int		rows;
+	int		cols;
+	int		row;
+	int		col;
+	int		srcRow;
+	int		srcCol;
+	int		sym;
+	int		len;
+	int		bestLen;
+
+	minRow = rowMax + 1;
+	minCol = colMax + 1;
+	maxRow = 0;
+	maxCol = 0;
+
+	for (row = 1; row <= rowMax; row++)
+	{
+		for (col = 1; col <= colMax; col++)
+		{
+			if (findCell(row, col, gen)->state != ON)
+				continue;
+
+			if (row < minRow)
+				minRow = row;
+
+			if (row > maxRow)
+				maxRow = row;
+
+			if (col < minCol)
+				minCol = col;
+
+			if (col > maxCol)
+				maxCol = col;
+		}
+	}
+
+	height = (maxRow > 0) ? (maxRow - minRow + 1) : 0;
+	width = (maxCol > 0) ? (maxCol - minCol + 1) : 0;
+	bestLen = 0;
+
+	/*
+	 * The orientations from 4 on swap the rows and columns, and then
+	 * each orientation can flip the rows and the columns of the box.
+	 */
+	for (sym = 0; sym < 8; sym++)
+	{
+		rows = (sym < 4) ? height : width;
+		cols = (sym < 4) ? width : height;
+
+		cp = form;
+		*cp++ = rows >> 8;
+		*cp++ = rows;
+		*cp++ = cols >> 8;
+		*cp++ = cols;
+
+		for (row = 0; row < rows; row++)
+		{
+			for (col = 0; col < cols; col++)
+			{
+				srcRow = (sym < 4) ? row : col;
+				srcCol = (sym < 4) ? col : row;
+
+				if (sym & 1)
+					srcRow = height - 1 - srcRow;
+
+				if (sym & 2)
+					srcCol = width - 1 - srcCol;
+
+				*cp++ = (findCell(minRow + srcRow, minCol + srcCol,
+					gen)->state == ON);
+			}
+		}
+
+		len = cp - form;
+
+		if ((bestLen == 0) || (memcmp(form, best, len) < 0))
+		{
+			memcpy(best, form, len);
+			bestLen = len;
+		}
+	}
+
+	return bestLen;
+}
+
+/* END CODE */